@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <string_view>
+
+//synthetic source generators for the lexer benchmarks
+//every generator is seeded, so a given kind and size always produces the
+//same text and runs can be compared against each other.
+namespace corpus {
+    enum class Kind {
+        Identifiers,
+        Numbers,
+        Operators,
+        Strings,
+        Whitespace,
+        Mixed
+    };
+
+    constexpr Kind allKinds[] = {Kind::Identifiers, Kind::Numbers, Kind::Operators,
+                                 Kind::Strings, Kind::Whitespace, Kind::Mixed};
+
+    inline const char* name(Kind kind) {
+        switch (kind) {
+            case Kind::Identifiers:
+                return "identifiers";
+            case Kind::Numbers:
+                return "numbers";
+            case Kind::Operators:
+                return "operators";
+            case Kind::Strings:
+                return "strings";
+            case Kind::Whitespace:
+                return "whitespace";
+            case Kind::Mixed:
+                return "mixed";
+        }
+        return "unknown";
+    }
+
+    inline void appendWord(std::string& out, std::mt19937& rng, size_t minLength, size_t maxLength) {
+        static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        size_t length = minLength + rng() % (maxLength - minLength + 1);
+        out += letters[rng() % 52];
+        for (size_t i = 1; i < length; i++) {
+            unsigned pick = rng() % 62;
+            out += pick < 52 ? letters[pick] : static_cast<char>('0' + pick - 52);
+        }
+    }
+
+    //appends an operator or delimiter, keeping a slash apart from whatever
+    //follows so random output never opens a comment that swallows the rest
+    inline void appendSymbol(std::string& out, const char* symbol) {
+        out += symbol;
+        if (symbol[0] == '/') {
+            out += ' ';
+        }
+    }
+
+    inline void appendNumber(std::string& out, std::mt19937& rng) {
+        out += std::to_string(rng() % 100000);
+        if (rng() % 3 == 0) {
+            out += '.';
+            out += std::to_string(rng() % 10000);
+        }
+    }
+
+    /// @brief Generates a corpus of one kind.
+    ///
+    /// @param kind The kind of content to favour.
+    /// @param size The approximate size of the corpus in bytes.
+    ///
+    /// @return The generated source text.
+    inline std::string generate(Kind kind, size_t size) {
+        static const char* keywords[] = {"int", "float", "if", "else", "while", "for", "return", "void"};
+        static const char* symbols[] = {"+", "-", "*", "/", "%", "(", ")", "[", "]", ":", "{", "}", ";", "="};
+        constexpr size_t symbolCount = sizeof(symbols) / sizeof(symbols[0]);
+        std::mt19937 rng(static_cast<unsigned>(kind) * 7919 + 1);
+        std::string out;
+        out.reserve(size + 256);
+        while (out.size() < size) {
+            switch (kind) {
+                case Kind::Identifiers:
+                    if (rng() % 8 == 0) {
+                        out += keywords[rng() % 8];
+                    } else {
+                        appendWord(out, rng, 1, 16);
+                    }
+                    out += rng() % 10 == 0 ? '\n' : ' ';
+                    break;
+                case Kind::Numbers:
+                    appendNumber(out, rng);
+                    out += rng() % 10 == 0 ? '\n' : ' ';
+                    break;
+                case Kind::Operators:
+                    appendSymbol(out, symbols[rng() % symbolCount]);
+                    if (rng() % 6 == 0) {
+                        appendWord(out, rng, 1, 3);
+                    }
+                    if (rng() % 4 == 0) {
+                        out += ' ';
+                    }
+                    break;
+                case Kind::Strings:
+                    out += '"';
+                    for (size_t words = 1 + rng() % 12; words > 0; words--) {
+                        appendWord(out, rng, 1, 10);
+                        out += ' ';
+                    }
+                    if (rng() % 4 == 0) {
+                        out += "\\n";
+                    }
+                    out += "\" ";
+                    break;
+                case Kind::Whitespace:
+                    out += '\n';
+                    out.append(rng() % 40, rng() % 2 ? ' ' : '\t');
+                    appendWord(out, rng, 1, 8);
+                    out.append(1 + rng() % 16, ' ');
+                    break;
+                case Kind::Mixed:
+                    switch (rng() % 6) {
+                        case 0:
+                            out += keywords[rng() % 8];
+                            break;
+                        case 1:
+                        case 2:
+                            appendWord(out, rng, 1, 10);
+                            break;
+                        case 3:
+                            appendNumber(out, rng);
+                            break;
+                        default:
+                            appendSymbol(out, symbols[rng() % symbolCount]);
+                            break;
+                    }
+                    out += rng() % 3 == 0 ? "" : (rng() % 8 == 0 ? "\n    " : " ");
+                    break;
+            }
+        }
+        return out;
+    }
+}
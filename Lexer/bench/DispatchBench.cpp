@@ -0,0 +1,264 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "../include/Lexer.h"
+#include "Corpus.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//counts hardware branch mispredictions around a block of code, where the
+//kernel lets us (perf_event_paranoid, containers), otherwise reports nothing
+class BranchMissCounter {
+private:
+    int fd = -1;
+
+public:
+    BranchMissCounter() {
+#if defined(__linux__)
+        perf_event_attr attr = {};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~BranchMissCounter() {
+#if defined(__linux__)
+        if (fd >= 0) {
+            close(fd);
+        }
+#endif
+    }
+
+    bool available() const {
+        return fd >= 0;
+    }
+
+    void start() {
+#if defined(__linux__)
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    uint64_t stop() {
+        uint64_t count = 0;
+#if defined(__linux__)
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+        }
+#endif
+        return count;
+    }
+};
+
+/// @brief Builds a corpus mixing every character class in random order.
+///
+/// Short identifiers, numbers, operators, delimiters, strings and stray
+/// bytes are interleaved so that the class of the next character is
+/// unpredictable, which is the worst case for a comparison chain. Symbols
+/// go through corpus::appendSymbol() so no comment swallows the rest.
+///
+/// @param size The approximate size of the corpus in bytes.
+///
+/// @return The generated source text.
+std::string mixedCorpus(size_t size) {
+    std::mt19937 rng(42);
+    const char* pieces[] = {"x", "count", "while", "i", "42", "3.14", "+", "-", "*", "/", "%",
+                            "(", ")", "[", "]", ":", " ", "\n", "\t", "{", ";", "}", "=", "7",
+                            "\"text\"", "caf\xc3\xa9", "@"};
+    std::uniform_int_distribution<size_t> pick(0, sizeof(pieces) / sizeof(pieces[0]) - 1);
+    std::string text;
+    text.reserve(size + 16);
+    while (text.size() < size) {
+        corpus::appendSymbol(text, pieces[pick(rng)]);
+        if (rng() % 3 == 0) {
+            text += ' ';
+        }
+    }
+    return text;
+}
+
+/// @brief Classifies a character with a comparison chain, as tokenize() used to.
+///
+/// Covers the same classes as the charclass table, so both passes below do
+/// the same work and must agree on the checksum.
+///
+/// @param c The character to classify.
+///
+/// @return The CharClass of c.
+CharClass chainClassify(char c) {
+    unsigned char byte = static_cast<unsigned char>(c);
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        return CharClass::Whitespace;
+    } else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+        return CharClass::Letter;
+    } else if (c >= '0' && c <= '9') {
+        return CharClass::Digit;
+    } else if (c == '+' || c == '-' || c == '*' || c == '/' || c == '%' || c == '=' || c == '<' || c == '>'
+               || c == '!' || c == '&' || c == '|' || c == '^' || c == '~' || c == '.' || c == '?') {
+        return CharClass::Operator;
+    } else if (c == '(' || c == ')' || c == ':' || c == '[' || c == ']' || c == '{' || c == '}' || c == ';'
+               || c == ',') {
+        return CharClass::Delimiter;
+    } else if (c == '"') {
+        return CharClass::Quote;
+    } else if (byte >= 0xC2 && byte <= 0xF4) {
+        return CharClass::Utf8;
+    }
+    return CharClass::Other;
+}
+
+//lexer dispatching nextToken() through chainClassify(), the way tokenize()
+//did before the charclass table
+struct ChainTraits : LexerTraits {
+    static CharClass classify(char c) {
+        return chainClassify(c);
+    }
+};
+
+/// @brief Checks that chainClassify() agrees with the charclass table on every byte.
+bool chainMatchesTable() {
+    for (int c = 0; c < 256; c++) {
+        if (chainClassify(static_cast<char>(c)) != charclass::of(static_cast<char>(c))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Folds per-class counts into one number both dispatch passes must agree on.
+uint64_t checksum(const uint64_t (&counts)[charclass::count]) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < charclass::count; i++) {
+        sum = sum * 31 + counts[i];
+    }
+    return sum;
+}
+
+//result of one timed pass
+struct Sample {
+    double seconds;
+    uint64_t branchMisses;
+    uint64_t checksum;
+};
+
+/// @brief Runs a pass over the corpus a few times and keeps the fastest.
+template <typename Pass>
+Sample measure(BranchMissCounter& counter, Pass pass) {
+    Sample best = {1e30, 0, 0};
+    for (int run = 0; run < 5; run++) {
+        counter.start();
+        auto begin = std::chrono::steady_clock::now();
+        uint64_t checksum = pass();
+        auto end = std::chrono::steady_clock::now();
+        uint64_t misses = counter.stop();
+        double seconds = std::chrono::duration<double>(end - begin).count();
+        if (seconds < best.seconds) {
+            best = {seconds, misses, checksum};
+        }
+    }
+    return best;
+}
+
+void report(const char* name, const Sample& sample, size_t bytes, const BranchMissCounter& counter) {
+    std::printf("%-22s %8.1f MB/s", name, bytes / sample.seconds / 1e6);
+    if (counter.available()) {
+        std::printf("  %10llu branch misses  %6.3f per byte", static_cast<unsigned long long>(sample.branchMisses),
+               static_cast<double>(sample.branchMisses) / bytes);
+    } else {
+        std::printf("  branch misses n/a");
+    }
+    std::printf("  (checksum %llu)\n", static_cast<unsigned long long>(sample.checksum));
+}
+
+/// @brief Pulls every token of text out of a lexer with nextToken().
+///
+/// @return A checksum of the token types and lengths, equal for lexers that agree.
+template <typename LexerType>
+uint64_t pullTokens(const std::string& text) {
+    LexerType lexer(SourceBuffer::borrow(text));
+    uint64_t sum = 0;
+    for (Token token; lexer.nextToken(token);) {
+        sum = sum * 31 + static_cast<uint64_t>(token.type) * 1000003 + token.value.size();
+    }
+    return sum;
+}
+
+/**
+ * @brief Compares comparison-chain and table-driven character dispatch.
+ *
+ * Classifies every byte of a mixed-content corpus both ways, then lexes it
+ * with nextToken() dispatching through each, checking that both pairs
+ * agree. Prints throughput and, where perf events are readable, hardware
+ * branch mispredictions per byte. The classification passes isolate the
+ * lookup itself, the nextToken() passes show what it is worth in the lexer.
+ *
+ * Usage: DispatchBench [size in MB]
+ */
+int main(int argc, char* argv[]) {
+    if (!chainMatchesTable()) {
+        std::fprintf(stderr, "chainClassify() disagrees with the charclass table\n");
+        return 1;
+    }
+    size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 16;
+    std::string corpus = mixedCorpus(megabytes << 20);
+    BranchMissCounter counter;
+    if (!counter.available()) {
+        std::printf("perf events unavailable, reporting throughput only\n");
+    }
+
+    Sample chain = measure(counter, [&] {
+        uint64_t counts[charclass::count] = {};
+        for (char c : corpus) {
+            counts[static_cast<int>(chainClassify(c))]++;
+        }
+        return checksum(counts);
+    });
+    report("comparison chain", chain, corpus.size(), counter);
+
+    Sample table = measure(counter, [&] {
+        uint64_t counts[charclass::count] = {};
+        for (char c : corpus) {
+            counts[static_cast<int>(charclass::of(c))]++;
+        }
+        return checksum(counts);
+    });
+    report("charclass table", table, corpus.size(), counter);
+    if (chain.checksum != table.checksum) {
+        std::fprintf(stderr, "the comparison chain and the table classified the corpus differently\n");
+        return 1;
+    }
+
+    Sample chainLexing = measure(counter, [&] {
+        return pullTokens<BasicLexer<ChainTraits>>(corpus);
+    });
+    report("nextToken() via chain", chainLexing, corpus.size(), counter);
+
+    Sample tableLexing = measure(counter, [&] {
+        return pullTokens<Lexer>(corpus);
+    });
+    report("nextToken() via table", tableLexing, corpus.size(), counter);
+    if (chainLexing.checksum != tableLexing.checksum) {
+        std::fprintf(stderr, "the two dispatch strategies lexed the corpus differently\n");
+        return 1;
+    }
+    return 0;
+}
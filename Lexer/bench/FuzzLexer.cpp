@@ -0,0 +1,624 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../include/BatchLexer.h"
+#include "../include/IncrementalLexer.h"
+#include "../include/Lexer.h"
+#include "../include/ParallelLexer.h"
+#include "../include/TokenCache.h"
+#include "../include/TokenPipeline.h"
+#include "../include/TokenStream.h"
+#include "Corpus.h"
+
+//what every way of lexing an input has to agree on
+struct Lexed {
+    TokenBuffer tokens;
+    std::vector<Diagnostic> problems;
+    //set when lexing stopped with a LexError, at the offset it reported
+    bool failed = false;
+    size_t failedAt = 0;
+};
+
+/// @brief Appends a token to a buffer, kind included.
+void append(TokenBuffer& tokens, const Token& token) {
+    tokens.push(token.type, static_cast<uint32_t>(token.offset), static_cast<uint32_t>(token.value.size()), Token::noId,
+                token.kindByte());
+}
+
+/// @brief Lexes an input with the active kernels through one of the lexer's interfaces.
+///
+/// @param run Called as run(lexer, tokens) to lex into tokens.
+template <typename LexerType = Lexer, typename Run>
+Lexed lexVia(std::string_view input, ErrorMode mode, Run run) {
+    Lexed result;
+    LexerType lexer(SourceBuffer::borrow(input));
+    lexer.setErrorMode(mode);
+    try {
+        run(lexer, result.tokens);
+    } catch (const LexError& e) {
+        result.failed = true;
+        result.failedAt = e.diagnostic().offset;
+    }
+    result.problems = lexer.diagnostics();
+    return result;
+}
+
+/// @brief Lexes an input with the active kernels into a TokenBuffer.
+template <typename LexerType = Lexer>
+Lexed lexWith(std::string_view input, ErrorMode mode) {
+    return lexVia<LexerType>(input, mode, [](LexerType& lexer, TokenBuffer& tokens) { lexer.tokenize(tokens); });
+}
+
+bool sameTokens(const TokenBuffer& a, const TokenBuffer& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a.type(i) != b.type(i) || a.offset(i) != b.offset(i) || a.length(i) != b.length(i)
+            || a.kind(i) != b.kind(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameResult(const Lexed& a, const Lexed& b) {
+    if (a.failed != b.failed || a.failedAt != b.failedAt || a.problems.size() != b.problems.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.problems.size(); i++) {
+        if (a.problems[i].offset != b.problems[i].offset || a.problems[i].length != b.problems[i].length) {
+            return false;
+        }
+    }
+    //a failed run keeps whatever it lexed before the throw, which depends on
+    //how the work was split, only the error itself has to agree
+    return a.failed || sameTokens(a.tokens, b.tokens);
+}
+
+/// @brief Checks tokens from a TokenCache against a fresh lex, messages included.
+bool sameCached(const Lexed& reference, const CachedTokens& cached) {
+    const std::vector<Diagnostic>& problems = cached.diagnostics();
+    if (!sameTokens(reference.tokens, cached.buffer()) || reference.problems.size() != problems.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < problems.size(); i++) {
+        const Diagnostic& expected = reference.problems[i];
+        if (expected.offset != problems[i].offset || expected.length != problems[i].length
+            || std::strcmp(expected.message, problems[i].message) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Reports a disagreement and aborts, which a fuzzer records as a crash.
+///
+/// The input is saved to mismatch.bin so the failure can be replayed with
+/// FuzzLexer mismatch.bin.
+[[noreturn]] void mismatch(const char* mode, std::string_view input) {
+    std::fprintf(stderr, "%s disagrees with the scalar reference on a %zu byte input, saved to mismatch.bin\n", mode,
+            input.size());
+    if (FILE* file = std::fopen("mismatch.bin", "wb")) {
+        std::fwrite(input.data(), 1, input.size(), file);
+        std::fclose(file);
+    }
+    std::abort();
+}
+
+//lexer counting lines as it goes, without decoding lexemes, the one
+//configuration no library target instantiates
+struct LocatingTraits : LexerTraits {
+    static constexpr bool lexemes = false;
+    static constexpr bool trackLocations = true;
+};
+
+//compiles every member of it, not only the ones the checks call
+template class BasicLexer<LocatingTraits>;
+
+/// @brief Lexes an input tracking locations, checking each against a LineIndex.
+///
+/// Every token location lex() passes on and the location locate() gives for
+/// every diagnostic have to match what a LineIndex of the whole input says.
+Lexed lexLocated(std::string_view input, ErrorMode mode) {
+    Lexed result;
+    BasicLexer<LocatingTraits> lexer(SourceBuffer::borrow(input));
+    lexer.setErrorMode(mode);
+    LineIndex lines(input);
+    auto check = [&](SourceLocation actual, size_t offset) {
+        SourceLocation expected = lines.locate(offset);
+        if (actual.line != expected.line || actual.column != expected.column) {
+            mismatch("a tracked location", input);
+        }
+    };
+    try {
+        lexer.lex([&](const Token& token, SourceLocation where) {
+            check(where, token.offset);
+            append(result.tokens, token);
+        });
+    } catch (const LexError& e) {
+        result.failed = true;
+        result.failedAt = e.diagnostic().offset;
+        check(lexer.locate(result.failedAt), result.failedAt);
+    }
+    result.problems = lexer.diagnostics();
+    for (const Diagnostic& problem : result.problems) {
+        check(lexer.locate(problem.offset), problem.offset);
+    }
+    return result;
+}
+
+/// @brief Lexes an input through the lexer's other interfaces and checks each against reference.
+///
+/// Covers a TokenPipeline with batches small enough to wrap its ring,
+/// tokenizeInArena() and tokenize() into OwnedTokens, whose lexemes also
+/// have to be copies of the source.
+void checkInterfaces(std::string_view input, ErrorMode mode, const Lexed& reference) {
+    Lexed piped = lexVia(input, mode, [](Lexer& lexer, TokenBuffer& tokens) {
+        TokenPipeline pipeline(lexer, 3, 2);
+        for (Token token; pipeline.next(token);) {
+            append(tokens, token);
+        }
+    });
+    if (!sameResult(reference, piped)) {
+        mismatch("TokenPipeline", input);
+    }
+
+    Lexed arena = lexVia(input, mode, [](Lexer& lexer, TokenBuffer& tokens) {
+        for (const Token& token : lexer.tokenizeInArena()) {
+            append(tokens, token);
+        }
+    });
+    if (!sameResult(reference, arena)) {
+        mismatch("tokenizeInArena()", input);
+    }
+
+    Lexed owned = lexVia(input, mode, [input](Lexer& lexer, TokenBuffer& tokens) {
+        std::vector<OwnedToken> list;
+        lexer.tokenize(list);
+        for (const OwnedToken& token : list) {
+            if (token.value != input.substr(token.offset, token.value.size())) {
+                mismatch("an OwnedToken lexeme", input);
+            }
+            append(tokens, token.view());
+        }
+    });
+    if (!sameResult(reference, owned)) {
+        mismatch("tokenize() into OwnedTokens", input);
+    }
+}
+
+/// @brief Checks lexing with a SymbolTable and a ConstantPool attached, and its token stream.
+///
+/// The tokens have to match reference. Every identifier's id has to name
+/// its lexeme and every literal's id has to index the value lexing it
+/// without pools gives, strings decoded. Encoded with its string table, the
+/// token stream has to give back the tokens and the identifier names.
+void checkPooled(std::string_view input, ErrorMode mode, const Lexed& reference) {
+    SymbolTable symbols;
+    ConstantPool constants;
+    Lexed pooled = lexVia(input, mode, [&](Lexer& lexer, TokenBuffer& tokens) {
+        lexer.setSymbolTable(&symbols);
+        lexer.setConstantPool(&constants);
+        tokens = TokenBuffer(true);
+        lexer.tokenize(tokens);
+    });
+    if (!sameResult(reference, pooled)) {
+        mismatch("lexing with pools attached", input);
+    }
+    if (pooled.failed) {
+        return;
+    }
+
+    Lexer plain(SourceBuffer::borrow(input));
+    plain.setErrorMode(mode);
+    size_t i = 0;
+    for (Token token; plain.nextToken(token); i++) {
+        uint32_t id = pooled.tokens.id(i);
+        bool same;
+        switch (token.type) {
+            case TokenType::Identifier:
+                same = id < symbols.size() && symbols.name(id) == token.value;
+                break;
+            case TokenType::Integer:
+                same = id < constants.integerCount() && constants.integerValue(id) == token.intValue;
+                break;
+            case TokenType::Float: {
+                double value = id < constants.floatCount() ? constants.floatValue(id) : 0;
+                same = id < constants.floatCount() && std::memcmp(&value, &token.floatValue, sizeof(value)) == 0;
+                break;
+            }
+            case TokenType::String:
+                same = id < constants.stringCount() && constants.stringValue(id) == plain.stringValue(token);
+                break;
+            default:
+                same = id == Token::noId;
+                break;
+        }
+        if (!same) {
+            mismatch("a pooled constant", input);
+        }
+    }
+
+    std::string stream = tokenstream::encode(pooled.tokens, input.size(), &symbols);
+    TokenStreamReader reader(stream);
+    TokenBuffer decoded(true);
+    reader.readInto(decoded);
+    if (!sameTokens(pooled.tokens, decoded)) {
+        mismatch("the token stream round trip with a string table", input);
+    }
+    for (size_t j = 0; j < decoded.size(); j++) {
+        bool named = decoded.type(j) == TokenType::Identifier;
+        if (named ? decoded.id(j) >= reader.stringCount() || reader.string(decoded.id(j)) != decoded.text(j, input)
+                  : decoded.id(j) != Token::noId) {
+            mismatch("the token stream string table", input);
+        }
+    }
+}
+
+/**
+ * @brief Checks every fast lexing mode against the scalar reference on one input.
+ *
+ * In each error mode the scalar kernels give the reference, which the SIMD
+ * kernels, the parallel lexer with boundaries every few bytes, the
+ * highlighting configuration and one tracking locations have to reproduce
+ * exactly, as do the lexer's other interfaces, see checkInterfaces() and
+ * checkPooled(). A TokenCache entry has to decode to the same tokens and
+ * diagnostics it was encoded from, the binary token stream has to round
+ * trip, and re-lexing an edit that rebuilds the input from its two halves
+ * has to match lexing it whole.
+ *
+ * @param input The bytes to lex.
+ */
+void checkInput(std::string_view input) {
+    const charscan::Kernels* preferred = charscan::active;
+    Lexed fullReference;
+    for (ErrorMode mode : {ErrorMode::Tokens, ErrorMode::Recover, ErrorMode::FailFast}) {
+        charscan::useIsa(charscan::Isa::Scalar);
+        Lexed reference = lexWith(input, mode);
+        for (charscan::Isa isa : {charscan::Isa::Sse2, charscan::Isa::Avx2, charscan::Isa::Neon}) {
+            if (charscan::useIsa(isa) && !sameResult(reference, lexWith(input, mode))) {
+                mismatch(charscan::active->name, input);
+            }
+        }
+        charscan::active = preferred;
+
+        Lexed parallel;
+        try {
+            SegmentedTokens segments = tokenizeParallel(input, 4, mode, 16);
+            for (size_t i = 0; i < segments.size(); i++) {
+                append(parallel.tokens, segments[i]);
+            }
+            parallel.problems = segments.diagnostics();
+        } catch (const LexError& e) {
+            parallel.failed = true;
+            parallel.failedAt = e.diagnostic().offset;
+        }
+        if (!sameResult(reference, parallel)) {
+            mismatch("tokenizeParallel()", input);
+        }
+        if (!sameResult(reference, lexWith<HighlightLexer>(input, mode))) {
+            mismatch("HighlightLexer", input);
+        }
+        if (!sameResult(reference, lexLocated(input, mode))) {
+            mismatch("the location tracking configuration", input);
+        }
+        checkInterfaces(input, mode, reference);
+        checkPooled(input, mode, reference);
+        if (!reference.failed) {
+            //round trips in memory, so fuzzing leaves no cache entries behind
+            std::string entry = TokenCache::encodeEntry(input, reference.tokens, reference.problems, mode);
+            std::optional<CachedTokens> cached = TokenCache::decodeEntry(entry, input, mode);
+            if (!cached || !cached->fromCache() || !sameCached(reference, *cached)) {
+                mismatch("the TokenCache entry round trip", input);
+            }
+        }
+        if (mode == ErrorMode::Tokens) {
+            fullReference = std::move(reference);
+        }
+    }
+
+    TokenBuffer decoded;
+    TokenStreamReader(tokenstream::encode(fullReference.tokens, input.size())).readInto(decoded);
+    if (!sameTokens(fullReference.tokens, decoded)) {
+        mismatch("the token stream round trip", input);
+    }
+
+    size_t cut = input.size() / 3;
+    size_t end = input.size() - cut;
+    IncrementalLexer incremental(std::string(input.substr(0, cut)) + std::string(input.substr(end)));
+    incremental.apply({cut, 0, input.substr(cut, end - cut)});
+    if (!sameTokens(fullReference.tokens, incremental.tokenBuffer())) {
+        mismatch("relex()", input);
+    }
+}
+
+#ifdef LEXER_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    checkInput(std::string_view(reinterpret_cast<const char*>(data), size));
+    return 0;
+}
+#else
+
+/// @brief Returns the fastest of a few lexing runs over text, in seconds.
+double timeLexing(const std::string& text) {
+    double best = 1e30;
+    for (int run = 0; run < 5; run++) {
+        auto begin = std::chrono::steady_clock::now();
+        Lexer lexer(SourceBuffer::borrow(text));
+        lexer.setErrorMode(ErrorMode::Recover);
+        TokenBuffer tokens;
+        lexer.tokenize(tokens);
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+    }
+    return best;
+}
+
+/// @brief Repeats an input back to back until it reaches size bytes.
+std::string repeat(std::string_view input, size_t size) {
+    std::string text;
+    text.reserve(size + input.size());
+    while (text.size() < size) {
+        text += input.empty() ? std::string_view(" ") : input;
+    }
+    return text;
+}
+
+//timing of one input, repeated to a fixed size so short inputs can be timed
+struct Timing {
+    std::string input;
+    double nanosecondsPerByte;
+    //time for 8x the bytes over 8x the time, about 1 for linear lexing
+    double growth = 0;
+};
+
+/// @brief Measures how lexing time grows when the input is repeated 8 times more.
+double growthOf(std::string_view input, size_t size) {
+    std::string small = repeat(input, size);
+    std::string large = repeat(small, small.size() * 8);
+    return timeLexing(large) / (8 * timeLexing(small));
+}
+
+//inputs that reach every diagnostic, checked before any random ones
+const std::string_view edgeCaseSeeds[] = {
+    "x = 99999999999999999999;\n", "9223372036854775807 9223372036854775808", "1e999 1.5e-999",
+    "y = 100000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+    "000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+    "000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000.5;",
+    "1.2.3", "\"unterminated", "\"line\nbreak\"", "\"escape at end\\", "\"\\q\"", "/* unterminated",
+    "/* /* nested */ */", "a // comment", "a /", "\"a\" /* \" */ \"b"
+};
+
+/// @brief Checks literals around the limits of a double convert and report as documented.
+///
+/// A float too large is infinity and an error, one too small for even a
+/// denormal is 0 and no error, which the differential checks can't see as
+/// every configuration would agree on the wrong answer.
+void checkFloatLimits() {
+    struct Case {
+        std::string text;
+        bool reported;
+    };
+    const Case cases[] = {
+        {std::string(310, '9') + ".5", true},
+        {"0." + std::string(330, '0') + "1", false},
+        {"0." + std::string(320, '0') + "1", false},
+        {"00." + std::string(400, '0') + "7", false},
+    };
+    for (const Case& test : cases) {
+        Lexed lexed = lexWith(test.text, ErrorMode::Recover);
+        Lexer lexer(SourceBuffer::borrow(test.text));
+        Token token;
+        lexer.nextToken(token);
+        bool inRange = test.reported ? token.floatValue == std::numeric_limits<double>::infinity()
+                                     : token.floatValue >= 0 && token.floatValue < 1e-300;
+        if (token.type != TokenType::Float || !inRange || lexed.problems.empty() == test.reported) {
+            mismatch("the float limits", test.text);
+        }
+        checkInput(test.text);
+    }
+}
+
+/// @brief Appends a random run of digits.
+void appendDigits(std::mt19937& rng, std::string& out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out += static_cast<char>('0' + rng() % 10);
+    }
+}
+
+/// @brief Makes an input out of the constructs with diagnostics of their own.
+///
+/// Random bytes almost never produce the long digit runs that overflow a
+/// literal or the exact openings of strings and comments, so this strings
+/// together literals around the int64_t and double limits, unterminated
+/// strings and comments and nested block comments.
+std::string edgeCaseInput(std::mt19937& rng, size_t size) {
+    static constexpr std::string_view separators[] = {" ", "\n", ";", "", "+"};
+    std::string input;
+    do {
+        switch (rng() % 8) {
+            case 0:
+                appendDigits(rng, input, 1 + rng() % 25);
+                break;
+            case 1:
+                //long enough to overflow a double, or not quite
+                appendDigits(rng, input, 300 + rng() % 20);
+                input += '.';
+                appendDigits(rng, input, 1 + rng() % 3);
+                break;
+            case 2:
+                input += "0.";
+                input.append(300 + rng() % 40, '0');
+                input += '1';
+                break;
+            case 3:
+                appendDigits(rng, input, 1 + rng() % 3);
+                input += rng() % 2 ? "e" : ".5e-";
+                appendDigits(rng, input, 1 + rng() % 5);
+                break;
+            case 4:
+                input += rng() % 2 ? "\"open" : "\"escape \\";
+                break;
+            case 5:
+                input += "/* open";
+                break;
+            case 6:
+                input += rng() % 2 ? "/* /* nested */ */" : "// line";
+                break;
+            default:
+                input += "9223372036854775807";
+                input += static_cast<char>('7' + rng() % 3);
+                break;
+        }
+        input += separators[rng() % std::size(separators)];
+    } while (input.size() < size);
+    return input;
+}
+
+/// @brief Makes a random input, biased towards bytes the lexer treats specially.
+std::string randomInput(std::mt19937& rng, size_t maxSize, const std::vector<std::string>& corpora) {
+    static constexpr std::string_view interesting = "abzAZ_09.e \t\n\r\"\\/*+-=<>!&|^~?:;,(){}[]@#'$\x80\xa9\xc3\xcc\xe2\x82\xac\xe6\x97\xa5\xf0\x9f\xff";
+    size_t size = rng() % (maxSize + 1);
+    std::string input;
+    switch (rng() % 4) {
+        case 0:
+            for (size_t i = 0; i < size; i++) {
+                input += static_cast<char>(rng());
+            }
+            break;
+        case 1:
+            for (size_t i = 0; i < size; i++) {
+                input += interesting[rng() % interesting.size()];
+            }
+            break;
+        case 2:
+            input = edgeCaseInput(rng, size);
+            break;
+        default: {
+            const std::string& source = corpora[rng() % corpora.size()];
+            size_t start = rng() % (source.size() - std::min(size, source.size()) + 1);
+            input = source.substr(start, size);
+            for (size_t flips = input.empty() ? 0 : rng() % 4; flips > 0; flips--) {
+                input[rng() % input.size()] = interesting[rng() % interesting.size()];
+            }
+            break;
+        }
+    }
+    return input;
+}
+
+/**
+ * @brief Fuzzes the lexer's fast modes against the scalar reference and times every input.
+ *
+ * Inputs come from the files and directories given, such as a libFuzzer
+ * corpus, or are edgeCaseSeeds followed by inputs generated at random. Every input goes through
+ * checkInput(), which aborts on the first disagreement, and is timed
+ * repeated up to 16 KB. The slowest inputs per byte are then timed again at
+ * 8x the size and flagged when the time grows by more than the limit times
+ * 8, a sign of super-linear scanning. --no-timing skips the timing and
+ * only checks, for runs whose result must not depend on the machine's load.
+ *
+ * Build with -DLEXER_LIBFUZZER and -fsanitize=fuzzer to get a libFuzzer
+ * target with the same checks instead of this driver.
+ *
+ * Usage: FuzzLexer [--runs N] [--seed S] [--max-size bytes] [--growth-limit x] [--no-timing] [paths...]
+ *
+ * @return 0 if no input was flagged, 1 otherwise.
+ */
+int main(int argc, char* argv[]) {
+    size_t runs = 20000;
+    unsigned seed = 1;
+    size_t maxSize = 256;
+    double growthLimit = 2.5;
+    bool timeInputs = true;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = std::stoul(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (std::strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            maxSize = std::stoul(argv[++i]);
+        } else if (std::strcmp(argv[i], "--growth-limit") == 0 && i + 1 < argc) {
+            growthLimit = std::stod(argv[++i]);
+        } else if (std::strcmp(argv[i], "--no-timing") == 0) {
+            timeInputs = false;
+        } else if (std::strncmp(argv[i], "--", 2) == 0) {
+            std::fprintf(stderr,
+                         "usage: %s [--runs N] [--seed S] [--max-size bytes] [--growth-limit x] [--no-timing] [paths...]\n",
+                         argv[0]);
+            return 1;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    std::vector<std::string> inputs;
+    for (const std::string& path : batch::collectFiles(paths)) {
+        inputs.push_back(std::string(SourceBuffer::fromFile(path).view()));
+    }
+    if (paths.empty()) {
+        inputs.assign(std::begin(edgeCaseSeeds), std::end(edgeCaseSeeds));
+        std::mt19937 rng(seed);
+        std::vector<std::string> corpora;
+        for (corpus::Kind kind : corpus::allKinds) {
+            corpora.push_back(corpus::generate(kind, 64 << 10));
+        }
+        for (size_t i = 0; i < runs; i++) {
+            inputs.push_back(randomInput(rng, maxSize, corpora));
+        }
+    }
+
+    checkFloatLimits();
+    constexpr size_t timedSize = 16 << 10;
+    std::vector<Timing> timings;
+    for (const std::string& input : inputs) {
+        checkInput(input);
+        if (!timeInputs) {
+            continue;
+        }
+        std::string text = repeat(input, timedSize);
+        timings.push_back({input, timeLexing(text) * 1e9 / text.size()});
+    }
+    std::printf("%zu inputs agree with the scalar reference in every mode\n", inputs.size());
+    if (!timeInputs) {
+        return 0;
+    }
+
+    size_t slowest = std::min<size_t>(10, timings.size());
+    std::partial_sort(timings.begin(), timings.begin() + slowest, timings.end(),
+                 [](const Timing& a, const Timing& b) { return a.nanosecondsPerByte > b.nanosecondsPerByte; });
+    size_t flagged = 0;
+    std::printf("%10s %8s  input\n", "ns/byte", "growth");
+    for (size_t i = 0; i < slowest; i++) {
+        Timing& timing = timings[i];
+        timing.growth = growthOf(timing.input, timedSize);
+        bool superLinear = timing.growth > growthLimit;
+        flagged += superLinear;
+        std::string preview;
+        for (char c : timing.input.substr(0, 40)) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            if (byte >= 0x20 && byte < 0x7f && byte != '\\') {
+                preview += c;
+            } else {
+                char escaped[5];
+                std::snprintf(escaped, sizeof(escaped), "\\x%02x", byte);
+                preview += escaped;
+            }
+        }
+        std::printf("%10.2f %8.2f  %zu bytes \"%s\"%s\n", timing.nanosecondsPerByte, timing.growth, timing.input.size(),
+               preview.c_str(), superLinear ? "  SUPER-LINEAR" : "");
+    }
+    return flagged == 0 ? 0 : 1;
+}
+#endif
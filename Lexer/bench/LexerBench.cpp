@@ -0,0 +1,201 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/Lexer.h"
+#include "../include/ParallelLexer.h"
+#include "../include/TokenDump.h"
+#include "../include/TokenPipeline.h"
+#include "Corpus.h"
+
+//one way of lexing a corpus, returns the number of tokens produced
+struct Benchmark {
+    std::string name;
+    std::function<size_t(const std::string&)> run;
+};
+
+//the fastest run of a benchmark on one corpus
+struct Result {
+    double seconds;
+    size_t tokens;
+};
+
+/// @brief Lists every lexing mode worth tracking.
+///
+/// Each mode that trades memory layout, threading or kernels for speed gets
+/// its own entry, with the scalar kernels as the reference point.
+std::vector<Benchmark> benchmarks() {
+    std::vector<Benchmark> list;
+    list.push_back({"tokenize", [](const std::string& source) {
+        Lexer lexer(SourceBuffer::borrow(source));
+        return lexer.tokenize().size();
+    }});
+    list.push_back({"tokenize/scalar", [](const std::string& source) {
+        charscan::useIsa(charscan::Isa::Scalar);
+        Lexer lexer(SourceBuffer::borrow(source));
+        size_t count = lexer.tokenize().size();
+        charscan::useIsa(charscan::detectIsa());
+        return count;
+    }});
+    list.push_back({"tokenizeInArena", [](const std::string& source) {
+        Lexer lexer(SourceBuffer::borrow(source));
+        return lexer.tokenizeInArena().size();
+    }});
+    list.push_back({"nextToken", [](const std::string& source) {
+        Lexer lexer(SourceBuffer::borrow(source));
+        Token token;
+        size_t count = 0;
+        while (lexer.nextToken(token)) {
+            count++;
+        }
+        return count;
+    }});
+    list.push_back({"tokenBuffer", [](const std::string& source) {
+        Lexer lexer(SourceBuffer::borrow(source));
+        TokenBuffer buffer;
+        lexer.tokenize(buffer);
+        return buffer.size();
+    }});
+    list.push_back({"tokenBuffer/reused", [](const std::string& source) {
+        //one lexer and buffer for every run, as a batch worker keeps them
+        static Lexer lexer{SourceBuffer()};
+        static TokenBuffer buffer;
+        lexer.reset(SourceBuffer::borrow(source));
+        buffer.clear();
+        lexer.tokenize(buffer);
+        return buffer.size();
+    }});
+    list.push_back({"tokenBuffer/interned", [](const std::string& source) {
+        Lexer lexer(SourceBuffer::borrow(source));
+        SymbolTable symbols;
+        lexer.setSymbolTable(&symbols);
+        TokenBuffer buffer(true);
+        lexer.tokenize(buffer);
+        return buffer.size();
+    }});
+    list.push_back({"tokenBuffer/pooled", [](const std::string& source) {
+        Lexer lexer(SourceBuffer::borrow(source));
+        ConstantPool constants;
+        lexer.setConstantPool(&constants);
+        TokenBuffer buffer(true);
+        lexer.tokenize(buffer);
+        return buffer.size();
+    }});
+    list.push_back({"tokenBuffer/highlight", [](const std::string& source) {
+        HighlightLexer lexer(SourceBuffer::borrow(source));
+        TokenBuffer buffer;
+        lexer.tokenize(buffer);
+        return buffer.size();
+    }});
+    list.push_back({"parallel", [](const std::string& source) {
+        return tokenizeParallel(source).size();
+    }});
+    list.push_back({"pipeline", [](const std::string& source) {
+        //lexing on a second thread, with the consumer doing no work of its own
+        Lexer lexer(SourceBuffer::borrow(source));
+        TokenPipeline pipeline(lexer);
+        Token token;
+        size_t count = 0;
+        while (pipeline.next(token)) {
+            count++;
+        }
+        return count;
+    }});
+    //lexing plus dumping, so a dump should come in at no less than half the tokenBuffer rate
+    std::pair<const char*, DumpFormat> dumps[] = {
+        {"dump/text", DumpFormat::Text}, {"dump/json", DumpFormat::JsonLines}, {"dump/binary", DumpFormat::Binary}};
+    for (auto [name, format] : dumps) {
+        list.push_back({name, [format = format](const std::string& source) {
+            Lexer lexer(SourceBuffer::borrow(source));
+            TokenBuffer buffer;
+            lexer.tokenize(buffer);
+            FILE* sink = std::fopen("/dev/null", "wb");
+            dumpTokens(buffer, source, format, sink);
+            std::fclose(sink);
+            return buffer.size();
+        }});
+    }
+    return list;
+}
+
+/// @brief Runs a benchmark until it has used up minSeconds, keeping the fastest run.
+Result measure(const Benchmark& benchmark, const std::string& source, double minSeconds) {
+    Result best = {1e30, 0};
+    double total = 0;
+    for (int runs = 0; runs < 3 || total < minSeconds; runs++) {
+        auto begin = std::chrono::steady_clock::now();
+        size_t tokens = benchmark.run(source);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        total += seconds;
+        if (seconds < best.seconds) {
+            best = {seconds, tokens};
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Measures lexer throughput on generated corpora.
+ *
+ * Every benchmark runs on every corpus kind at sizes growing by 8x up to the
+ * maximum, and reports MB/s and millions of tokens per second. Output is a
+ * table by default, --csv prints one machine-readable line per result so
+ * runs can be diffed to catch regressions.
+ *
+ * Usage: LexerBench [--filter text] [--max-size MB] [--min-time seconds] [--csv]
+ */
+int main(int argc, char* argv[]) {
+    std::string filter;
+    size_t maxSize = 16 << 20;
+    double minSeconds = 0.2;
+    bool csv = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            maxSize = std::stoul(argv[++i]) << 20;
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minSeconds = std::stod(argv[++i]);
+        } else if (std::strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--filter text] [--max-size MB] [--min-time seconds] [--csv]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (csv) {
+        std::printf("benchmark,corpus,bytes,tokens,seconds,mb_per_s,mtokens_per_s\n");
+    } else {
+        std::printf("kernels: %s\n%-22s %-12s %10s %10s %10s %12s\n", charscan::active->name,
+               "benchmark", "corpus", "bytes", "tokens", "MB/s", "Mtokens/s");
+    }
+    std::vector<Benchmark> list = benchmarks();
+    for (corpus::Kind kind : corpus::allKinds) {
+        for (size_t size = 64 << 10; size <= maxSize; size *= 8) {
+            std::string source = corpus::generate(kind, size);
+            for (const Benchmark& benchmark : list) {
+                std::string label = benchmark.name + "/" + corpus::name(kind);
+                if (!filter.empty() && label.find(filter) == std::string::npos) {
+                    continue;
+                }
+                Result result = measure(benchmark, source, minSeconds);
+                double megabytes = source.size() / result.seconds / 1e6;
+                double megatokens = result.tokens / result.seconds / 1e6;
+                if (csv) {
+                    std::printf("%s,%s,%zu,%zu,%.6f,%.2f,%.3f\n", benchmark.name.c_str(), corpus::name(kind),
+                           source.size(), result.tokens, result.seconds, megabytes, megatokens);
+                } else {
+                    std::printf("%-22s %-12s %10zu %10zu %10.1f %12.2f\n", benchmark.name.c_str(), corpus::name(kind),
+                           source.size(), result.tokens, megabytes, megatokens);
+                }
+                std::fflush(stdout);
+            }
+        }
+    }
+    return 0;
+}
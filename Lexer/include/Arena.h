@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+//monotonic bump allocator, memory is only given back all at once by reset(),
+//release() or destroying the arena. Blocks are never moved, so pointers stay
+//valid until then. It is also a std::pmr::memory_resource, which lets
+//std::pmr containers such as the lexer's token lists live in it.
+//
+//containers keep a pointer to the arena, so an arena backing one must not
+//be moved while the container is in use.
+class Arena : public std::pmr::memory_resource {
+private:
+    struct Block {
+        std::unique_ptr<char[]> memory;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current = 0;
+    char* cursor = nullptr;
+    size_t remaining = 0;
+    size_t blockSize;
+    size_t used = 0;
+
+    /// @brief Moves to a block with room for at least size bytes.
+    ///
+    /// Reuses a block kept by reset() when one is big enough, otherwise
+    /// takes a new one from the heap.
+    void grow(size_t size) {
+        for (size_t next = blocks.empty() ? 0 : current + 1; next < blocks.size(); next++) {
+            if (blocks[next].size >= size) {
+                use(next);
+                return;
+            }
+        }
+        size_t length = std::max(blockSize, size);
+        blocks.push_back({std::unique_ptr<char[]>(new char[length]), length});
+        use(blocks.size() - 1);
+    }
+
+    void use(size_t index) {
+        current = index;
+        cursor = blocks[index].memory.get();
+        remaining = blocks[index].size;
+    }
+
+    static size_t paddingFor(const char* pointer, size_t alignment) {
+        return (alignment - reinterpret_cast<uintptr_t>(pointer) % alignment) % alignment;
+    }
+
+protected:
+    void* do_allocate(size_t size, size_t alignment) override {
+        return allocate(size, alignment);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    /// @brief Constructor for Arena.
+    ///
+    /// @param blockSize The size of each block requested from the heap.
+    explicit Arena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {
+    }
+
+    Arena(Arena&& other) noexcept
+        : blocks(std::move(other.blocks)), current(other.current), cursor(other.cursor), remaining(other.remaining),
+          blockSize(other.blockSize), used(other.used) {
+        other.release();
+    }
+
+    Arena& operator=(Arena&& other) noexcept {
+        if (this != &other) {
+            blocks = std::move(other.blocks);
+            current = other.current;
+            cursor = other.cursor;
+            remaining = other.remaining;
+            blockSize = other.blockSize;
+            used = other.used;
+            other.release();
+        }
+        return *this;
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /// @brief Allocates uninitialized memory from the current block.
+    ///
+    /// @param size The number of bytes needed.
+    /// @param alignment The alignment needed, a power of two.
+    ///
+    /// @return A pointer valid until the arena is reset or destroyed.
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        size_t padding = paddingFor(cursor, alignment);
+        if (cursor == nullptr || padding + size > remaining) {
+            grow(size + alignment);
+            padding = paddingFor(cursor, alignment);
+        }
+        char* result = cursor + padding;
+        cursor = result + size;
+        remaining -= padding + size;
+        used += size;
+        return result;
+    }
+
+    /// @brief Copies text into the arena.
+    ///
+    /// @param text The text to copy.
+    ///
+    /// @return A view of the copy, valid until the arena is reset or destroyed.
+    std::string_view copy(std::string_view text) {
+        if (text.empty()) {
+            return std::string_view();
+        }
+        char* storage = static_cast<char*>(allocate(text.size(), 1));
+        std::memcpy(storage, text.data(), text.size());
+        return std::string_view(storage, text.size());
+    }
+
+    /// @brief Frees everything allocated so far in one shot, keeping the blocks.
+    ///
+    /// Later allocations reuse the same memory, so a warmed-up arena stops
+    /// calling the heap. Everything handed out before is invalidated.
+    void reset() {
+        used = 0;
+        if (!blocks.empty()) {
+            use(0);
+        }
+    }
+
+    /// @brief Frees everything and gives the blocks back to the heap.
+    void release() {
+        blocks.clear();
+        current = 0;
+        cursor = nullptr;
+        remaining = 0;
+        used = 0;
+    }
+
+    /// @brief Returns the number of bytes handed out since the last reset.
+    size_t bytesUsed() const {
+        return used;
+    }
+
+    /// @brief Returns the number of bytes held in blocks.
+    size_t bytesReserved() const {
+        size_t total = 0;
+        for (const Block& block : blocks) {
+            total += block.size;
+        }
+        return total;
+    }
+};
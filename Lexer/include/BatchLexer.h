@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Lexer.h"
+#include "ThreadPool.h"
+#include "TokenBuffer.h"
+#include "TokenCache.h"
+
+//outcome of lexing one file in a batch
+struct FileResult {
+    std::string path;
+    size_t bytes = 0;
+    size_t tokens = 0;
+    size_t diagnostics = 0;
+    double seconds = 0;
+    bool cached = false;
+    std::string error;
+};
+
+namespace batch {
+    /// @brief Expands command line arguments into a list of source files.
+    ///
+    /// Directories are walked recursively and contribute every regular file
+    /// under them, in sorted order. Anything else is taken as a file path.
+    ///
+    /// @param arguments The paths given by the user.
+    ///
+    /// @return The files to lex.
+    inline std::vector<std::string> collectFiles(const std::vector<std::string>& arguments) {
+        std::vector<std::string> files;
+        for (const std::string& argument : arguments) {
+            std::error_code error;
+            if (std::filesystem::is_directory(argument, error)) {
+                std::vector<std::string> found;
+                for (const auto& entry : std::filesystem::recursive_directory_iterator(argument, error)) {
+                    if (entry.is_regular_file(error)) {
+                        found.push_back(entry.path().string());
+                    }
+                }
+                std::sort(found.begin(), found.end());
+                files.insert(files.end(), found.begin(), found.end());
+            } else {
+                files.push_back(argument);
+            }
+        }
+        return files;
+    }
+}
+
+//how lexFiles() runs a batch
+struct BatchOptions {
+    //number of workers, 0 for one per core
+    size_t threads = 0;
+    //token cache to use, or nullptr to always lex
+    const TokenCache* cache = nullptr;
+    //receives the counters of every worker's lexer merged, or nullptr
+    LexerStats* stats = nullptr;
+    //in ErrorMode::FailFast the first problem fails its file and every
+    //file after it in the list is skipped, as in a run one file at a time
+    ErrorMode errorMode = ErrorMode::Tokens;
+};
+
+/**
+ * @brief Lexes many files concurrently on a work-stealing pool.
+ *
+ * Every worker keeps one Lexer and one TokenBuffer and reuses them for each
+ * file it picks up, so the per-file cost is mapping the file and lexing it.
+ * Files that can't be read or fail in fail-fast mode are reported in
+ * FileResult::error. With a cache, files whose tokens are already cached
+ * aren't lexed at all, and the tokens of the others are stored for the next
+ * run together with their diagnostics.
+ *
+ * @param files The files to lex.
+ * @param options The threads, cache, stats and error mode to use.
+ *
+ * @return One result per file, in the order of files.
+ */
+inline std::vector<FileResult> lexFiles(const std::vector<std::string>& files, const BatchOptions& options = {}) {
+    std::vector<FileResult> results(files.size());
+    ThreadPool pool(options.threads);
+    std::vector<Lexer> lexers;
+    lexers.reserve(pool.size());
+    std::vector<TokenBuffer> buffers(pool.size());
+    for (size_t i = 0; i < pool.size(); i++) {
+        lexers.emplace_back(SourceBuffer());
+        lexers.back().setErrorMode(options.errorMode);
+    }
+    const TokenCache* cache = options.cache;
+    //index of the first file in the list that failed fast, files.size() while none has
+    std::atomic<size_t> firstFailure(files.size());
+    auto fail = [&firstFailure](size_t i) {
+        size_t first = firstFailure.load();
+        while (i < first && !firstFailure.compare_exchange_weak(first, i)) {
+        }
+    };
+
+    for (size_t i = 0; i < files.size(); i++) {
+        pool.submit([&, i] {
+            size_t worker = ThreadPool::currentWorker();
+            Lexer& lexer = lexers[worker];
+            TokenBuffer& buffer = buffers[worker];
+            FileResult& result = results[i];
+            result.path = files[i];
+            if (i > firstFailure.load()) {
+                return;
+            }
+            auto begin = std::chrono::steady_clock::now();
+            try {
+                lexer.reset(SourceBuffer::fromFile(files[i]));
+                result.bytes = lexer.text().size();
+                if (cache) {
+                    if (std::optional<CachedTokens> cached = cache->lookup(lexer.text(), options.errorMode)) {
+                        result.tokens = cached->view().size();
+                        result.diagnostics = cached->diagnostics().size();
+                        result.cached = true;
+                        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                        return;
+                    }
+                }
+                buffer.clear();
+                lexer.tokenize(buffer);
+                result.tokens = buffer.size();
+                result.diagnostics = lexer.diagnostics().size();
+                if (cache) {
+                    cache->store(lexer.text(), buffer, lexer.diagnostics(), options.errorMode);
+                }
+            } catch (const LexError& e) {
+                result.error = files[i] + ":" + e.what();
+                fail(i);
+            } catch (const std::exception& e) {
+                result.error = e.what();
+                if (options.errorMode == ErrorMode::FailFast) {
+                    fail(i);
+                }
+            }
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        });
+    }
+    pool.wait();
+    //files after the first failure may still have run while it was lexed,
+    //they are reported skipped whichever worker got there first
+    for (size_t i = firstFailure.load() + 1; i < files.size(); i++) {
+        results[i] = FileResult();
+        results[i].path = files[i];
+        results[i].error = files[i] + ": skipped after an earlier failure";
+    }
+    if (options.stats) {
+        for (const Lexer& lexer : lexers) {
+            options.stats->merge(lexer.stats());
+        }
+    }
+    return results;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+//classes the lexer dispatches on, one per kind of token a character can start
+enum class CharClass : uint8_t {
+    Whitespace,
+    Letter,
+    Digit,
+    Operator,
+    Delimiter,
+    Quote,
+    //lead byte of a multi-byte UTF-8 sequence, which may start an identifier
+    Utf8,
+    Other
+};
+
+//maps every byte to its CharClass, so the tokenizer dispatch costs a single
+//table load and one jump instead of a chain of comparisons
+namespace charclass {
+    constexpr std::string_view whitespace = " \t\n\r";
+    //the first bytes of operators::list, Operators.h checks the two agree
+    constexpr std::string_view operators = "+-*/%=<>!&|^~.?";
+    constexpr std::string_view delimiters = "():[]{};,";
+    constexpr std::string_view quotes = "\"";
+
+    //number of classes, for arrays indexed by CharClass
+    constexpr size_t count = static_cast<size_t>(CharClass::Other) + 1;
+
+    constexpr std::array<CharClass, 256> build() {
+        std::array<CharClass, 256> table = {};
+        for (CharClass& entry : table) {
+            entry = CharClass::Other;
+        }
+        for (int c = 'a'; c <= 'z'; c++) {
+            table[c] = CharClass::Letter;
+            table[c - 'a' + 'A'] = CharClass::Letter;
+        }
+        for (int c = '0'; c <= '9'; c++) {
+            table[c] = CharClass::Digit;
+        }
+        for (char c : whitespace) {
+            table[static_cast<unsigned char>(c)] = CharClass::Whitespace;
+        }
+        for (char c : operators) {
+            table[static_cast<unsigned char>(c)] = CharClass::Operator;
+        }
+        for (char c : delimiters) {
+            table[static_cast<unsigned char>(c)] = CharClass::Delimiter;
+        }
+        for (char c : quotes) {
+            table[static_cast<unsigned char>(c)] = CharClass::Quote;
+        }
+        //0x80 to 0xC1 and 0xF5 up are continuation bytes or never valid
+        for (int c = 0xC2; c <= 0xF4; c++) {
+            table[c] = CharClass::Utf8;
+        }
+        return table;
+    }
+
+    inline constexpr std::array<CharClass, 256> table = build();
+
+    /// @brief Looks up the class of a character.
+    ///
+    /// @param c The character to classify.
+    ///
+    /// @return The CharClass of c.
+    constexpr CharClass of(char c) {
+        return table[static_cast<unsigned char>(c)];
+    }
+
+    static_assert(of('q') == CharClass::Letter && of('7') == CharClass::Digit && of('\n') == CharClass::Whitespace);
+    static_assert(of('%') == CharClass::Operator && of(']') == CharClass::Delimiter && of('\xff') == CharClass::Other);
+    static_assert(of('"') == CharClass::Quote && of('\'') == CharClass::Other);
+    static_assert(of('\xc3') == CharClass::Utf8 && of('\x80') == CharClass::Other && of('\xf5') == CharClass::Other);
+}
@@ -0,0 +1,416 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define LEXER_HAVE_SSE2 1
+#define LEXER_HAVE_AVX2 1
+#include <immintrin.h>
+#elif defined(__GNUC__) && defined(__aarch64__)
+#define LEXER_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+//vectorized kernels that find the end of a run of same-class characters
+//each kernel returns a pointer to the first byte in [p, end) outside the class,
+//or end if the run reaches the end of the input. findByte is the reverse and
+//stops at the first byte equal to c. Vector loads never read past end, the
+//last partial block is finished by the scalar loop.
+namespace charscan {
+
+    inline bool isWhitespace(unsigned char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    inline bool isAlphaNumeric(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+    }
+
+    inline bool isNumberChar(unsigned char c) {
+        return (c >= '0' && c <= '9') || c == '.';
+    }
+
+    //anything a string literal can hold before its closing quote, an escape
+    //or a newline, the three places the lexer has to look at a byte itself
+    inline bool isStringBody(unsigned char c) {
+        return c != '"' && c != '\\' && c != '\n';
+    }
+
+    /// @brief Finds the end of a run, calling kernel only for a long one.
+    ///
+    /// The first Inline bytes are tested one at a time, which for runs that
+    /// usually end within them is cheaper than the indirect call and vector
+    /// setup of a kernel. Only a run known to go on past them, such as more
+    /// than one space of whitespace, is finished by kernel.
+    ///
+    /// @tparam InClass The test kernel vectorizes.
+    /// @tparam Inline How many bytes to test before calling kernel, 0 to call it straight away.
+    /// @param p The start of the run.
+    /// @param end The end of the input.
+    /// @param kernel The kernel testing the same class as InClass.
+    ///
+    /// @return The first byte in [p, end) outside the class, or end.
+    template <bool (*InClass)(unsigned char), size_t Inline>
+    inline const char* scan(const char* p, const char* end, const char* (*kernel)(const char*, const char*)) {
+        const char* limit = static_cast<size_t>(end - p) > Inline ? p + Inline : end;
+        while (p < limit && InClass(static_cast<unsigned char>(*p))) {
+            ++p;
+        }
+        return p == limit && p != end && InClass(static_cast<unsigned char>(*p)) ? kernel(p, end) : p;
+    }
+
+    //instruction sets a kernel can be built for, in order of preference
+    enum class Isa {
+        Scalar,
+        Sse2,
+        Avx2,
+        Neon
+    };
+
+    struct Kernels {
+        Isa isa;
+        const char* name;
+        const char* (*skipWhitespace)(const char* p, const char* end);
+        const char* (*scanAlphaNumeric)(const char* p, const char* end);
+        const char* (*scanNumber)(const char* p, const char* end);
+        const char* (*scanStringBody)(const char* p, const char* end);
+        const char* (*findByte)(const char* p, const char* end, char c);
+    };
+
+    namespace scalar {
+        template <bool (*InClass)(unsigned char)>
+        inline const char* scanWhile(const char* p, const char* end) {
+            while (p < end && InClass(static_cast<unsigned char>(*p))) {
+                ++p;
+            }
+            return p;
+        }
+
+        inline const char* skipWhitespace(const char* p, const char* end) {
+            return scanWhile<isWhitespace>(p, end);
+        }
+
+        inline const char* scanAlphaNumeric(const char* p, const char* end) {
+            return scanWhile<isAlphaNumeric>(p, end);
+        }
+
+        inline const char* scanNumber(const char* p, const char* end) {
+            return scanWhile<isNumberChar>(p, end);
+        }
+
+        inline const char* scanStringBody(const char* p, const char* end) {
+            return scanWhile<isStringBody>(p, end);
+        }
+
+        inline const char* findByte(const char* p, const char* end, char c) {
+            while (p < end && *p != c) {
+                ++p;
+            }
+            return p;
+        }
+    }
+
+    //character classes the vector kernels know how to test
+    enum class Class {
+        Whitespace,
+        AlphaNumeric,
+        Number,
+        StringBody
+    };
+
+#ifdef LEXER_HAVE_SSE2
+    namespace sse2 {
+        /// @brief Tests each byte of v for lo <= byte <= hi.
+        ///
+        /// SSE2 only has signed byte compares, so the range is shifted to
+        /// start at -128 and tested with a single signed less-than.
+        inline __m128i inRange(__m128i v, char lo, char hi) {
+            __m128i shifted = _mm_xor_si128(_mm_sub_epi8(v, _mm_set1_epi8(lo)), _mm_set1_epi8(static_cast<char>(0x80)));
+            return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(hi - lo + 1 - 128)));
+        }
+
+        template <Class C>
+        inline __m128i classMask(__m128i v) {
+            if constexpr (C == Class::Whitespace) {
+                return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+                                    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+            } else if constexpr (C == Class::AlphaNumeric) {
+                return _mm_or_si128(inRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z'), inRange(v, '0', '9'));
+            } else if constexpr (C == Class::Number) {
+                return _mm_or_si128(inRange(v, '0', '9'), _mm_cmpeq_epi8(v, _mm_set1_epi8('.')));
+            } else {
+                __m128i stops = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+                                             _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+                return _mm_cmpeq_epi8(stops, _mm_setzero_si128());
+            }
+        }
+
+        template <Class C, bool (*InClass)(unsigned char)>
+        inline const char* scanWhile(const char* p, const char* end) {
+            while (end - p >= 16) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                unsigned outside = ~static_cast<unsigned>(_mm_movemask_epi8(classMask<C>(block))) & 0xFFFFu;
+                if (outside != 0) {
+                    return p + __builtin_ctz(outside);
+                }
+                p += 16;
+            }
+            return scalar::scanWhile<InClass>(p, end);
+        }
+
+        inline const char* skipWhitespace(const char* p, const char* end) {
+            return scanWhile<Class::Whitespace, isWhitespace>(p, end);
+        }
+
+        inline const char* scanAlphaNumeric(const char* p, const char* end) {
+            return scanWhile<Class::AlphaNumeric, isAlphaNumeric>(p, end);
+        }
+
+        inline const char* scanNumber(const char* p, const char* end) {
+            return scanWhile<Class::Number, isNumberChar>(p, end);
+        }
+
+        inline const char* scanStringBody(const char* p, const char* end) {
+            return scanWhile<Class::StringBody, isStringBody>(p, end);
+        }
+
+        inline const char* findByte(const char* p, const char* end, char c) {
+            __m128i needle = _mm_set1_epi8(c);
+            while (end - p >= 16) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                unsigned found = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+                if (found != 0) {
+                    return p + __builtin_ctz(found);
+                }
+                p += 16;
+            }
+            return scalar::findByte(p, end, c);
+        }
+    }
+#endif
+
+#ifdef LEXER_HAVE_AVX2
+    //compiled for AVX2 through target attributes so the rest of the build
+    //keeps the baseline instruction set, only selected after a cpuid check
+    namespace avx2 {
+        __attribute__((target("avx2"))) inline __m256i inRange(__m256i v, char lo, char hi) {
+            __m256i shifted = _mm256_xor_si256(_mm256_sub_epi8(v, _mm256_set1_epi8(lo)), _mm256_set1_epi8(static_cast<char>(0x80)));
+            return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi - lo + 1 - 128)), shifted);
+        }
+
+        template <Class C>
+        __attribute__((target("avx2"))) inline __m256i classMask(__m256i v) {
+            if constexpr (C == Class::Whitespace) {
+                return _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+                                       _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+            } else if constexpr (C == Class::AlphaNumeric) {
+                return _mm256_or_si256(inRange(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z'), inRange(v, '0', '9'));
+            } else if constexpr (C == Class::Number) {
+                return _mm256_or_si256(inRange(v, '0', '9'), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.')));
+            } else {
+                __m256i stops = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+                                                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+                return _mm256_cmpeq_epi8(stops, _mm256_setzero_si256());
+            }
+        }
+
+        template <Class C, bool (*InClass)(unsigned char)>
+        __attribute__((target("avx2"))) inline const char* scanWhile(const char* p, const char* end) {
+            while (end - p >= 32) {
+                __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                uint32_t outside = ~static_cast<uint32_t>(_mm256_movemask_epi8(classMask<C>(block)));
+                if (outside != 0) {
+                    return p + __builtin_ctz(outside);
+                }
+                p += 32;
+            }
+            return sse2::scanWhile<C, InClass>(p, end);
+        }
+
+        __attribute__((target("avx2"))) inline const char* skipWhitespace(const char* p, const char* end) {
+            return scanWhile<Class::Whitespace, isWhitespace>(p, end);
+        }
+
+        __attribute__((target("avx2"))) inline const char* scanAlphaNumeric(const char* p, const char* end) {
+            return scanWhile<Class::AlphaNumeric, isAlphaNumeric>(p, end);
+        }
+
+        __attribute__((target("avx2"))) inline const char* scanNumber(const char* p, const char* end) {
+            return scanWhile<Class::Number, isNumberChar>(p, end);
+        }
+
+        __attribute__((target("avx2"))) inline const char* scanStringBody(const char* p, const char* end) {
+            return scanWhile<Class::StringBody, isStringBody>(p, end);
+        }
+
+        __attribute__((target("avx2"))) inline const char* findByte(const char* p, const char* end, char c) {
+            __m256i needle = _mm256_set1_epi8(c);
+            while (end - p >= 32) {
+                __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                uint32_t found = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+                if (found != 0) {
+                    return p + __builtin_ctz(found);
+                }
+                p += 32;
+            }
+            return sse2::findByte(p, end, c);
+        }
+    }
+#endif
+
+#ifdef LEXER_HAVE_NEON
+    namespace neon {
+        inline uint8x16_t inRange(uint8x16_t v, char lo, char hi) {
+            return vcleq_u8(vsubq_u8(v, vdupq_n_u8(static_cast<uint8_t>(lo))), vdupq_n_u8(static_cast<uint8_t>(hi - lo)));
+        }
+
+        template <Class C>
+        inline uint8x16_t classMask(uint8x16_t v) {
+            if constexpr (C == Class::Whitespace) {
+                return vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('\t'))),
+                                vorrq_u8(vceqq_u8(v, vdupq_n_u8('\n')), vceqq_u8(v, vdupq_n_u8('\r'))));
+            } else if constexpr (C == Class::AlphaNumeric) {
+                return vorrq_u8(inRange(vorrq_u8(v, vdupq_n_u8(0x20)), 'a', 'z'), inRange(v, '0', '9'));
+            } else if constexpr (C == Class::Number) {
+                return vorrq_u8(inRange(v, '0', '9'), vceqq_u8(v, vdupq_n_u8('.')));
+            } else {
+                return vmvnq_u8(vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))),
+                                         vceqq_u8(v, vdupq_n_u8('\n'))));
+            }
+        }
+
+        template <Class C, bool (*InClass)(unsigned char)>
+        inline const char* scanWhile(const char* p, const char* end) {
+            while (end - p >= 16) {
+                uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+                uint8x16_t outside = vmvnq_u8(classMask<C>(block));
+                //narrow each byte of the mask to a nibble, NEON has no movemask
+                uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(outside), 4)), 0);
+                if (bits != 0) {
+                    return p + (__builtin_ctzll(bits) >> 2);
+                }
+                p += 16;
+            }
+            return scalar::scanWhile<InClass>(p, end);
+        }
+
+        inline const char* skipWhitespace(const char* p, const char* end) {
+            return scanWhile<Class::Whitespace, isWhitespace>(p, end);
+        }
+
+        inline const char* scanAlphaNumeric(const char* p, const char* end) {
+            return scanWhile<Class::AlphaNumeric, isAlphaNumeric>(p, end);
+        }
+
+        inline const char* scanNumber(const char* p, const char* end) {
+            return scanWhile<Class::Number, isNumberChar>(p, end);
+        }
+
+        inline const char* scanStringBody(const char* p, const char* end) {
+            return scanWhile<Class::StringBody, isStringBody>(p, end);
+        }
+
+        inline const char* findByte(const char* p, const char* end, char c) {
+            uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(c));
+            while (end - p >= 16) {
+                uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+                uint8x16_t found = vceqq_u8(block, needle);
+                uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(found), 4)), 0);
+                if (bits != 0) {
+                    return p + (__builtin_ctzll(bits) >> 2);
+                }
+                p += 16;
+            }
+            return scalar::findByte(p, end, c);
+        }
+    }
+#endif
+
+    /// @brief Returns the kernel set for an instruction set.
+    ///
+    /// @param isa The instruction set to look up.
+    ///
+    /// @return The kernels for isa, or nullptr if they weren't compiled in.
+    inline const Kernels* kernelsFor(Isa isa) {
+        static const Kernels scalarKernels = {Isa::Scalar, "scalar", scalar::skipWhitespace, scalar::scanAlphaNumeric,
+                                              scalar::scanNumber, scalar::scanStringBody, scalar::findByte};
+#ifdef LEXER_HAVE_SSE2
+        static const Kernels sse2Kernels = {Isa::Sse2, "sse2", sse2::skipWhitespace, sse2::scanAlphaNumeric,
+                                            sse2::scanNumber, sse2::scanStringBody, sse2::findByte};
+#endif
+#ifdef LEXER_HAVE_AVX2
+        static const Kernels avx2Kernels = {Isa::Avx2, "avx2", avx2::skipWhitespace, avx2::scanAlphaNumeric,
+                                            avx2::scanNumber, avx2::scanStringBody, avx2::findByte};
+#endif
+#ifdef LEXER_HAVE_NEON
+        static const Kernels neonKernels = {Isa::Neon, "neon", neon::skipWhitespace, neon::scanAlphaNumeric,
+                                            neon::scanNumber, neon::scanStringBody, neon::findByte};
+#endif
+        switch (isa) {
+            case Isa::Scalar:
+                return &scalarKernels;
+#ifdef LEXER_HAVE_SSE2
+            case Isa::Sse2:
+                return &sse2Kernels;
+#endif
+#ifdef LEXER_HAVE_AVX2
+            case Isa::Avx2:
+                return &avx2Kernels;
+#endif
+#ifdef LEXER_HAVE_NEON
+            case Isa::Neon:
+                return &neonKernels;
+#endif
+            default:
+                return nullptr;
+        }
+    }
+
+    /// @brief Checks if the running CPU can execute a kernel set.
+    ///
+    /// @param isa The instruction set to check.
+    ///
+    /// @return True if isa was compiled in and the CPU supports it.
+    inline bool isSupported(Isa isa) {
+        if (kernelsFor(isa) == nullptr) {
+            return false;
+        }
+#ifdef LEXER_HAVE_AVX2
+        if (isa == Isa::Avx2) {
+            //may run during static initialization, before libgcc probed the CPU
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        }
+#endif
+        return true;
+    }
+
+    /// @brief Picks the widest kernel set the running CPU supports.
+    ///
+    /// @return The preferred instruction set for this machine.
+    inline Isa detectIsa() {
+        for (Isa isa : {Isa::Avx2, Isa::Neon, Isa::Sse2}) {
+            if (isSupported(isa)) {
+                return isa;
+            }
+        }
+        return Isa::Scalar;
+    }
+
+    //kernels used by every Lexer, chosen once at startup
+    inline const Kernels* active = kernelsFor(detectIsa());
+
+    /// @brief Forces a kernel set, e.g. to benchmark or cross-check the scalar path.
+    ///
+    /// @param isa The instruction set to switch to.
+    ///
+    /// @return True if the switch happened, false if isa isn't supported here.
+    inline bool useIsa(Isa isa) {
+        if (!isSupported(isa)) {
+            return false;
+        }
+        active = kernelsFor(isa);
+        return true;
+    }
+}
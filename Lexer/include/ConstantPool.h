@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "Arena.h"
+#include "Hash.h"
+
+//deduplicates literal values into one dense pool per literal type, so
+//literal tokens can carry an index an interpreter loads the constant by
+//without converting or comparing lexemes. Strings are stored decoded and
+//copied into an arena, the pool doesn't depend on the source staying alive.
+class ConstantPool {
+private:
+    //values in first-seen order, indexed by an open-addressed hash table.
+    //Most literals in a source are distinct, so a node per value, as in
+    //std::unordered_map, cost more than lexing them
+    template <typename Value>
+    struct Pool {
+        //low half of the value's hash, which also places it in the table,
+        //and its index into values plus 1, 0 for an empty slot
+        struct Slot {
+            uint32_t hash;
+            uint32_t id;
+        };
+
+        std::vector<Value> values;
+        std::vector<Slot> slots;
+
+        /// @brief Returns the index of a value, adding make() if it's new.
+        ///
+        /// @param hash The hash of the value.
+        /// @param same Tests if a stored value is the one looked for.
+        /// @param make Returns the value to store, only called if it's new.
+        template <typename Same, typename Make>
+        uint32_t add(uint64_t hash, Same same, Make make) {
+            if (4 * (values.size() + 1) > 3 * slots.size()) {
+                rehash();
+            }
+            uint32_t tag = static_cast<uint32_t>(hash);
+            size_t mask = slots.size() - 1;
+            size_t i = tag & mask;
+            for (; slots[i].id != 0; i = (i + 1) & mask) {
+                if (slots[i].hash == tag && same(values[slots[i].id - 1])) {
+                    return slots[i].id - 1;
+                }
+            }
+            values.push_back(make());
+            slots[i] = {tag, static_cast<uint32_t>(values.size())};
+            return slots[i].id - 1;
+        }
+
+        void rehash() {
+            std::vector<Slot> old(std::max<size_t>(16, 2 * slots.size()), Slot{0, 0});
+            old.swap(slots);
+            size_t mask = slots.size() - 1;
+            for (const Slot& slot : old) {
+                if (slot.id != 0) {
+                    size_t i = slot.hash & mask;
+                    while (slots[i].id != 0) {
+                        i = (i + 1) & mask;
+                    }
+                    slots[i] = slot;
+                }
+            }
+        }
+    };
+
+    Arena arena;
+    Pool<int64_t> integers;
+    //compared by bit pattern, so 0.0 and -0.0 stay apart and NaN is found again
+    Pool<double> floats;
+    Pool<std::string_view> strings;
+
+    //spreads a number's bits into the low ones the table is indexed by
+    static uint64_t mix(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        return value ^ value >> 33;
+    }
+
+    static uint64_t bitsOf(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+public:
+    /// @brief Returns the index of an integer constant, adding it if it's new.
+    ///
+    /// @param value The value of an Integer literal.
+    ///
+    /// @return Its index into the integer pool, counting up from 0 in first-seen order.
+    uint32_t addInteger(int64_t value) {
+        return integers.add(
+            mix(static_cast<uint64_t>(value)), [value](int64_t stored) { return stored == value; },
+            [value] { return value; });
+    }
+
+    /// @brief Returns the index of a float constant, adding it if it's new.
+    ///
+    /// @param value The value of a Float literal.
+    ///
+    /// @return Its index into the float pool.
+    uint32_t addFloat(double value) {
+        uint64_t bits = bitsOf(value);
+        return floats.add(
+            mix(bits), [bits](double stored) { return bitsOf(stored) == bits; }, [value] { return value; });
+    }
+
+    /// @brief Returns the index of a string constant, adding it if it's new.
+    ///
+    /// @param value The decoded contents of a String literal, copied if new.
+    ///
+    /// @return Its index into the string pool.
+    uint32_t addString(std::string_view value) {
+        return strings.add(
+            hash::xxh64(value), [value](std::string_view stored) { return stored == value; },
+            [this, value] { return arena.copy(value); });
+    }
+
+    int64_t integerValue(uint32_t id) const {
+        return integers.values[id];
+    }
+
+    double floatValue(uint32_t id) const {
+        return floats.values[id];
+    }
+
+    /// @brief Returns a string constant.
+    ///
+    /// @param id An index returned by addString().
+    ///
+    /// @return A view of the decoded contents, valid for the lifetime of the pool.
+    std::string_view stringValue(uint32_t id) const {
+        return strings.values[id];
+    }
+
+    size_t integerCount() const {
+        return integers.values.size();
+    }
+
+    size_t floatCount() const {
+        return floats.values.size();
+    }
+
+    size_t stringCount() const {
+        return strings.values.size();
+    }
+
+    //number of constants across all three pools
+    size_t size() const {
+        return integerCount() + floatCount() + stringCount();
+    }
+};
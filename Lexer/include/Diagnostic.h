@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+//a problem found in the source, collected beside the token stream rather
+//than folded into it. Messages are static strings, so recording one never
+//allocates beyond the diagnostics vector itself.
+struct Diagnostic {
+    size_t offset;
+    size_t length;
+    const char* message;
+};
+
+//how a Lexer deals with bytes that don't start any token
+enum class ErrorMode : uint8_t {
+    //each such byte becomes an Unknown token
+    Tokens,
+    //each run of them is skipped and reported as a single Diagnostic
+    Recover,
+    //the first problem of any kind throws a LexError
+    FailFast
+};
+
+//thrown by a Lexer in ErrorMode::FailFast
+class LexError : public std::runtime_error {
+private:
+    Diagnostic problem;
+
+public:
+    /// @brief Constructor for LexError.
+    ///
+    /// @param problem The problem that stopped lexing.
+    /// @param where A prefix for the message, e.g. the line and column.
+    LexError(const Diagnostic& problem, const std::string& where)
+        : std::runtime_error(where + ": " + problem.message), problem(problem) {
+    }
+
+    const Diagnostic& diagnostic() const {
+        return problem;
+    }
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+//content hashing for the token cache
+namespace hash {
+    namespace detail {
+        constexpr uint64_t prime1 = 11400714785074694791ULL;
+        constexpr uint64_t prime2 = 14029467366897019727ULL;
+        constexpr uint64_t prime3 = 1609587929392839161ULL;
+        constexpr uint64_t prime4 = 9650029242287828579ULL;
+        constexpr uint64_t prime5 = 2870177450012600261ULL;
+
+        inline uint64_t rotl(uint64_t value, int bits) {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        inline uint64_t read64(const unsigned char* p) {
+            uint64_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline uint32_t read32(const unsigned char* p) {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline uint64_t round(uint64_t accumulator, uint64_t input) {
+            accumulator += input * prime2;
+            return rotl(accumulator, 31) * prime1;
+        }
+
+        inline uint64_t merge(uint64_t hash, uint64_t accumulator) {
+            hash ^= round(0, accumulator);
+            return hash * prime1 + prime4;
+        }
+    }
+
+    /// @brief Hashes bytes with XXH64.
+    ///
+    /// Matches the reference xxHash64 output on little-endian machines and
+    /// runs at several GB/s, so hashing a source costs far less than lexing it.
+    ///
+    /// @param data The bytes to hash.
+    /// @param seed The seed, 0 for the reference value.
+    ///
+    /// @return The 64-bit hash.
+    inline uint64_t xxh64(std::string_view data, uint64_t seed = 0) {
+        using namespace detail;
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(data.data());
+        const unsigned char* end = p + data.size();
+        uint64_t result;
+
+        if (data.size() >= 32) {
+            uint64_t v1 = seed + prime1 + prime2;
+            uint64_t v2 = seed + prime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - prime1;
+            do {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+                p += 32;
+            } while (end - p >= 32);
+            result = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            result = merge(result, v1);
+            result = merge(result, v2);
+            result = merge(result, v3);
+            result = merge(result, v4);
+        } else {
+            result = seed + prime5;
+        }
+        result += data.size();
+
+        while (end - p >= 8) {
+            result ^= round(0, read64(p));
+            result = rotl(result, 27) * prime1 + prime4;
+            p += 8;
+        }
+        if (end - p >= 4) {
+            result ^= static_cast<uint64_t>(read32(p)) * prime1;
+            result = rotl(result, 23) * prime2 + prime3;
+            p += 4;
+        }
+        while (p < end) {
+            result ^= *p * prime5;
+            result = rotl(result, 11) * prime1;
+            p++;
+        }
+
+        result ^= result >> 33;
+        result *= prime2;
+        result ^= result >> 29;
+        result *= prime3;
+        result ^= result >> 32;
+        return result;
+    }
+
+    /// @brief Hashes bytes with 64-bit FNV-1a at compile time.
+    ///
+    /// Much slower than xxh64() but constexpr, used to fingerprint tables
+    /// that are themselves built at compile time.
+    ///
+    /// @param data The bytes to hash.
+    /// @param hash The running hash, to chain several calls.
+    ///
+    /// @return The updated hash.
+    constexpr uint64_t fnv1a(std::string_view data, uint64_t hash = 14695981039346656037ULL) {
+        for (char c : data) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
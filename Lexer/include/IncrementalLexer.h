@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Lexer.h"
+#include "TokenBuffer.h"
+#include "Utf8.h"
+
+//a change to a source text: removed bytes at offset replaced by inserted
+struct TextEdit {
+    size_t offset;
+    size_t removed;
+    std::string_view inserted;
+};
+
+//what relex() had to redo for one edit
+struct RelexResult {
+    size_t firstToken;
+    size_t removedTokens;
+    size_t insertedTokens;
+};
+
+/**
+ * @brief Updates a token stream for an edit by re-lexing only around it.
+ *
+ * A token is decided by its own bytes and the code point after it, which
+ * says whether an identifier goes on, so tokens ending more than a code
+ * point before the edit can't change. Lexing restarts at the end of the last
+ * of those and stops as soon as it produces a token starting exactly where a
+ * shifted old token past the edit starts: from that point both streams come
+ * from the same lexer state over the same bytes and are identical. The cost
+ * is the size of the edit plus the tokens it disturbs, not the whole file.
+ *
+ * @param tokens The stream lexed from the text before the edit, updated in place.
+ * @param source The text after the edit.
+ * @param edit The edit that was applied.
+ * @param symbols The table to intern re-lexed identifiers into, or nullptr.
+ *
+ * @return Which tokens were replaced.
+ */
+inline RelexResult relex(TokenBuffer& tokens, std::string_view source, const TextEdit& edit, SymbolTable* symbols = nullptr) {
+    size_t editEnd = edit.offset + edit.removed;
+    size_t newEditEnd = edit.offset + edit.inserted.size();
+    int64_t shift = static_cast<int64_t>(edit.inserted.size()) - static_cast<int64_t>(edit.removed);
+
+    //first token that could be affected: the first one ending less than a
+    //code point before the edit
+    size_t low = 0;
+    size_t high = tokens.size();
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        if (tokens.offset(middle) + tokens.length(middle) + utf8::maxLength - 1 < edit.offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    size_t first = low;
+    size_t restart = first > 0 ? tokens.offset(first - 1) + tokens.length(first - 1) : 0;
+
+    Lexer lexer(SourceBuffer::borrow(source));
+    lexer.setSymbolTable(symbols);
+    lexer.seek(restart);
+    TokenBuffer replacement(tokens.hasIds());
+    size_t old = first;
+    bool synchronized = false;
+    Token token;
+    auto shifted = [&](size_t index) {
+        return static_cast<int64_t>(tokens.offset(index)) + shift;
+    };
+    while (lexer.nextToken(token)) {
+        size_t start = token.offset;
+        //old tokens starting before this one can no longer be matched
+        while (old < tokens.size() && (tokens.offset(old) < editEnd || shifted(old) < static_cast<int64_t>(start))) {
+            old++;
+        }
+        if (start >= newEditEnd && old < tokens.size() && shifted(old) == static_cast<int64_t>(start)) {
+            synchronized = true;
+            break;
+        }
+        replacement.push(token.type, static_cast<uint32_t>(start), static_cast<uint32_t>(token.value.length()), token.id,
+                         token.kindByte());
+    }
+    if (!synchronized) {
+        old = tokens.size();
+    }
+
+    RelexResult result = {first, old - first, replacement.size()};
+    tokens.splice(first, old, replacement, shift);
+    return result;
+}
+
+//keeps a source text and its token stream in step across edits, the way an
+//editor integration would hold one per open buffer
+class IncrementalLexer {
+private:
+    std::string text;
+    TokenBuffer tokens;
+
+public:
+    /// @brief Constructor for IncrementalLexer, lexes the whole text once.
+    ///
+    /// @param text The initial source text.
+    explicit IncrementalLexer(std::string text) : text(std::move(text)) {
+        Lexer lexer(SourceBuffer::borrow(this->text));
+        lexer.tokenize(tokens);
+    }
+
+    /// @brief Applies an edit to the text and re-lexes around it.
+    ///
+    /// @param edit The edit, with offset and removed relative to the current text.
+    ///
+    /// @return Which tokens were replaced.
+    RelexResult apply(const TextEdit& edit) {
+        text.replace(edit.offset, edit.removed, edit.inserted);
+        return relex(tokens, text, edit);
+    }
+
+    std::string_view source() const {
+        return text;
+    }
+
+    const TokenBuffer& tokenBuffer() const {
+        return tokens;
+    }
+};
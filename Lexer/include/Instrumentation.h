@@ -0,0 +1,180 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "CharClass.h"
+#include "Token.h"
+
+//build with -DLEXER_INSTRUMENTATION=1 to have every Lexer count what it does
+//left at 0 the recording calls in the hot path are empty inline functions
+//and compile away entirely, so the hooks can stay in production builds
+#ifndef LEXER_INSTRUMENTATION
+#define LEXER_INSTRUMENTATION 0
+#endif
+
+//phases of lexing that are timed separately, Load only by Lexer::fromFile()
+enum class LexerPhase : uint8_t {
+    Load,
+    Tokenize,
+    Intern,
+    Numbers
+};
+
+//counters gathered by an instrumented Lexer
+//tokenize time includes intern and number time, which are also broken out
+//comment bytes are counted as whitespace, string literal bytes as quote
+struct LexerStats {
+    static constexpr size_t typeCount = static_cast<size_t>(TokenType::Unknown) + 1;
+    static constexpr size_t classCount = charclass::count;
+    static constexpr size_t phaseCount = static_cast<size_t>(LexerPhase::Numbers) + 1;
+
+    uint64_t tokens[typeCount] = {};
+    uint64_t bytes[classCount] = {};
+    uint64_t keywordHits = 0;
+    uint64_t keywordMisses = 0;
+    uint64_t allocations = 0;
+    uint64_t nanoseconds[phaseCount] = {};
+
+    /// @brief Adds the counters of another lexer, e.g. one per batch worker.
+    void merge(const LexerStats& other) {
+        for (size_t i = 0; i < typeCount; i++) {
+            tokens[i] += other.tokens[i];
+        }
+        for (size_t i = 0; i < classCount; i++) {
+            bytes[i] += other.bytes[i];
+        }
+        keywordHits += other.keywordHits;
+        keywordMisses += other.keywordMisses;
+        allocations += other.allocations;
+        for (size_t i = 0; i < phaseCount; i++) {
+            nanoseconds[i] += other.nanoseconds[i];
+        }
+    }
+
+    /// @brief Formats the counters as a single JSON object.
+    ///
+    /// @return The JSON text, without a trailing newline.
+    std::string toJson() const {
+        static constexpr std::string_view classNames[classCount] = {
+            "whitespace", "letter", "digit", "operator", "delimiter", "quote", "utf8", "other"};
+        static constexpr std::string_view phaseNames[phaseCount] = {"load", "tokenize", "intern", "numbers"};
+
+        std::string json = "{\"tokens\":{";
+        for (size_t i = 0; i < typeCount; i++) {
+            std::string_view name = getTokenTypeName(static_cast<TokenType>(i));
+            json += (i ? ",\"" : "\"") + std::string(name) + "\":" + std::to_string(tokens[i]);
+        }
+        json += "},\"bytes\":{";
+        for (size_t i = 0; i < classCount; i++) {
+            json += (i ? ",\"" : "\"") + std::string(classNames[i]) + "\":" + std::to_string(bytes[i]);
+        }
+        json += "},\"keywordLookups\":{\"hits\":" + std::to_string(keywordHits) + ",\"misses\":" + std::to_string(keywordMisses);
+        json += "},\"allocations\":" + std::to_string(allocations) + ",\"seconds\":{";
+        for (size_t i = 0; i < phaseCount; i++) {
+            json += (i ? ",\"" : "\"") + std::string(phaseNames[i]) + "\":" + std::to_string(nanoseconds[i] / 1e9);
+        }
+        json += "}}";
+        return json;
+    }
+};
+
+namespace instrumentation {
+    constexpr bool enabled = LEXER_INSTRUMENTATION != 0;
+
+    //adds the time until it goes out of scope to one phase of a LexerStats
+    class PhaseTimer {
+    private:
+        uint64_t& total;
+        std::chrono::steady_clock::time_point begin;
+
+    public:
+        explicit PhaseTimer(uint64_t& total) : total(total), begin(std::chrono::steady_clock::now()) {
+        }
+
+        PhaseTimer(const PhaseTimer&) = delete;
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+        ~PhaseTimer() {
+            total += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+        }
+    };
+
+    //what a Lexer records into, a LexerStats when instrumentation is on
+    template <bool Enabled>
+    class Recorder {
+    private:
+        LexerStats counters;
+
+    public:
+        void countToken(TokenType type) {
+            counters.tokens[static_cast<size_t>(type)]++;
+        }
+
+        void countBytes(CharClass charClass, size_t count) {
+            counters.bytes[static_cast<size_t>(charClass)] += count;
+        }
+
+        void countKeywordLookup(bool hit) {
+            (hit ? counters.keywordHits : counters.keywordMisses)++;
+        }
+
+        void countAllocations(size_t count) {
+            counters.allocations += count;
+        }
+
+        void addTime(LexerPhase phase, uint64_t nanoseconds) {
+            counters.nanoseconds[static_cast<size_t>(phase)] += nanoseconds;
+        }
+
+        [[nodiscard]] PhaseTimer time(LexerPhase phase) {
+            return PhaseTimer(counters.nanoseconds[static_cast<size_t>(phase)]);
+        }
+
+        const LexerStats& stats() const {
+            return counters;
+        }
+
+        void clear() {
+            counters = LexerStats();
+        }
+    };
+
+    //stands in for a PhaseTimer when instrumentation is off
+    struct NoTimer {
+    };
+
+    template <>
+    class Recorder<false> {
+    public:
+        void countToken(TokenType) {
+        }
+
+        void countBytes(CharClass, size_t) {
+        }
+
+        void countKeywordLookup(bool) {
+        }
+
+        void countAllocations(size_t) {
+        }
+
+        void addTime(LexerPhase, uint64_t) {
+        }
+
+        NoTimer time(LexerPhase) {
+            return NoTimer();
+        }
+
+        const LexerStats& stats() const {
+            static const LexerStats none;
+            return none;
+        }
+
+        void clear() {
+        }
+    };
+}
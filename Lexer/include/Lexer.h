@@ -0,0 +1,792 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Arena.h"
+#include "CharClass.h"
+#include "CharScan.h"
+#include "ConstantPool.h"
+#include "Diagnostic.h"
+#include "Instrumentation.h"
+#include "LineIndex.h"
+#include "Operators.h"
+#include "SourceBuffer.h"
+#include "SymbolTable.h"
+#include "Token.h"
+#include "TokenBuffer.h"
+#include "Utf8.h"
+
+//keyword table shared by every lexer, built at compile time
+//words are placed by a perfect hash over their length, first and last
+//character, so classifying a word costs one hash and one comparison
+namespace keywords {
+    struct Entry {
+        std::string_view spelling;
+        KeywordKind kind = KeywordKind::None;
+    };
+
+    constexpr Entry list[] = {
+        {"int", KeywordKind::Int}, {"float", KeywordKind::Float}, {"string", KeywordKind::String},
+        {"if", KeywordKind::If}, {"else", KeywordKind::Else}, {"while", KeywordKind::While},
+        {"for", KeywordKind::For}, {"switch", KeywordKind::Switch}, {"case", KeywordKind::Case},
+        {"default", KeywordKind::Default}, {"break", KeywordKind::Break}, {"continue", KeywordKind::Continue},
+        {"return", KeywordKind::Return}, {"void", KeywordKind::Void}
+    };
+
+    constexpr size_t kindCount = static_cast<size_t>(KeywordKind::Void) + 1;
+
+    constexpr size_t tableSize = 32;
+
+    /// @brief Hashes a non-empty word into a keyword table slot.
+    ///
+    /// The multipliers were picked so that every entry of list gets its own
+    /// slot, the static_assert below fails if an edit to list breaks that.
+    ///
+    /// @param word The word to hash, must not be empty.
+    ///
+    /// @return The slot index in [0, tableSize).
+    constexpr size_t hash(std::string_view word) {
+        return (word.size() + 3 * static_cast<unsigned char>(word.front())
+                + 18 * static_cast<unsigned char>(word.back())) & (tableSize - 1);
+    }
+
+    struct Table {
+        Entry slots[tableSize] = {};
+        std::string_view spellings[kindCount] = {};
+        bool perfect = true;
+    };
+
+    constexpr Table build() {
+        Table table;
+        for (const Entry& entry : list) {
+            Entry& slot = table.slots[hash(entry.spelling)];
+            if (!slot.spelling.empty() || !table.spellings[static_cast<size_t>(entry.kind)].empty()) {
+                table.perfect = false;
+            }
+            slot = entry;
+            table.spellings[static_cast<size_t>(entry.kind)] = entry.spelling;
+        }
+        return table;
+    }
+
+    inline constexpr Table table = build();
+    static_assert(table.perfect, "keyword hash collides or a kind is listed twice, pick new multipliers in keywords::hash");
+
+    /// @brief Classifies a word without allocating.
+    ///
+    /// @param word The word to classify.
+    ///
+    /// @return Its kind if word is one of the entries of list, else None.
+    constexpr KeywordKind lookup(std::string_view word) {
+        if (word.empty()) {
+            return KeywordKind::None;
+        }
+        const Entry& slot = table.slots[hash(word)];
+        return slot.spelling == word ? slot.kind : KeywordKind::None;
+    }
+
+    /// @brief Checks if a word is a keyword without allocating.
+    constexpr bool contains(std::string_view word) {
+        return lookup(word) != KeywordKind::None;
+    }
+
+    /// @brief Returns how a keyword kind is written.
+    ///
+    /// @return A view of a static spelling, empty for None.
+    constexpr std::string_view spelling(KeywordKind kind) {
+        return table.spellings[static_cast<size_t>(kind)];
+    }
+
+    static_assert(contains("while") && contains("continue") && !contains("main") && !contains(""));
+    static_assert(lookup("return") == KeywordKind::Return && spelling(KeywordKind::Void) == "void");
+
+    //keyword set policies for LexerTraits::Keywords, empty ones skip the lookup
+    struct Default {
+        static constexpr bool empty = false;
+
+        static constexpr KeywordKind lookup(std::string_view word) {
+            return keywords::lookup(word);
+        }
+    };
+
+    //for configurations that lex every word as an identifier
+    struct None {
+        static constexpr bool empty = true;
+
+        static constexpr KeywordKind lookup(std::string_view) {
+            return KeywordKind::None;
+        }
+    };
+}
+
+//compile-time configuration of a BasicLexer, each one gets its own lexing
+//loop with the features it leaves out compiled away rather than tested for
+struct LexerTraits {
+    //the keyword set, a type like keywords::Default
+    using Keywords = keywords::Default;
+
+    //true to decode lexemes: convert numeric literals and intern identifiers
+    //into an attached SymbolTable. False leaves tokens as a type and a
+    //position, value still views the lexeme since that is its length.
+    static constexpr bool lexemes = true;
+
+    //true to count lines while lexing, so locate() and the sinks of lex()
+    //get the location of the current token without building a LineIndex
+    static constexpr bool trackLocations = false;
+
+    //picks the branch of nextToken() a token starting with c is lexed by
+    static CharClass classify(char c) {
+        return charclass::of(c);
+    }
+};
+
+//configuration for highlighting, which only needs token kinds and positions
+struct HighlightTraits : LexerTraits {
+    static constexpr bool lexemes = false;
+};
+
+//token list allocated from a Lexer's arena, see Lexer::tokenizeInArena()
+using TokenList = std::pmr::vector<Token>;
+
+//implements lexical analyser, configured at compile time by Traits
+template <typename Traits = LexerTraits>
+class BasicLexer {
+private:
+    SourceBuffer source;
+    std::string_view input;
+    size_t position;
+    SymbolTable* symbols = nullptr;
+    ConstantPool* constants = nullptr;
+    //held by pointer so moving the Lexer doesn't move the arena out from
+    //under the TokenLists allocated from it
+    std::unique_ptr<Arena> storage;
+    std::vector<Diagnostic> problems;
+    //string literals with escapes are decoded here before pooling, so only
+    //the pool's own copy of a new constant is ever allocated
+    std::string scratch;
+    ErrorMode mode = ErrorMode::Tokens;
+    //rebuilt in place after reset(), so its memory is reused across sources
+    LineIndex lineIndex;
+    bool linesIndexed = false;
+    instrumentation::Recorder<instrumentation::enabled> recorder;
+    //line of the current position and the offset it starts at, kept only
+    //with Traits::trackLocations
+    size_t line = 1;
+    size_t lineBegin = 0;
+    
+    /// @brief Extracts the next alphanumeric word from the input string.
+    ///
+    /// Scans the input string starting from the current position and extracts
+    /// the next sequence of alphanumeric characters, updating the position
+    /// to point to the first non-alphanumeric character after the word.
+    /// The vector kernel also stops at the first byte of 0x80 or above, only
+    /// then is a code point decoded and the word continued if it is
+    /// XID_Continue, so ASCII words pay one comparison for Unicode support.
+    ///
+    /// @return A view of the next alphanumeric word in the input string.
+    std::string_view getNextWord() {
+        size_t start = position;
+        position = advance<charscan::isAlphaNumeric, 0>(charscan::active->scanAlphaNumeric);
+        if (position < input.length() && static_cast<unsigned char>(input[position]) >= 0x80) {
+            continueUnicodeWord();
+        }
+        return lexeme(start);
+    }
+
+    //the slow path of getNextWord(), kept out of line so the ASCII path stays small
+    LEXER_COLD void continueUnicodeWord();
+
+    /// @brief Checks a non-ASCII code point for an identifier property.
+    ///
+    /// @param offset The offset of its lead byte.
+    /// @param property utf8::isIdentifierStart or utf8::isIdentifierContinue.
+    ///
+    /// @return Its length in bytes, or 0 if it is invalid or lacks property.
+    LEXER_COLD size_t unicodeAt(size_t offset, bool (*property)(uint32_t)) const;
+
+    /// @brief Returns the length of the character at offset, 1 for a byte that isn't valid UTF-8.
+    LEXER_COLD size_t characterLength(size_t offset) const;
+
+    /// @brief Returns the length of the unexpected character at offset.
+    ///
+    /// @return Its length, or 0 if a token or whitespace starts at offset.
+    size_t unexpectedAt(size_t offset) const {
+        CharClass charClass = charclass::of(input[offset]);
+        if (charClass == CharClass::Utf8 && unicodeAt(offset, utf8::isIdentifierStart) == 0) {
+            return characterLength(offset);
+        }
+        return charClass == CharClass::Other ? 1 : 0;
+    }
+
+    /// @brief Extracts the next numeric value from the input string.
+    ///
+    /// Scans the input string starting from the current position and extracts
+    /// the next sequence of digits and decimal points, lexNumber() decides
+    /// whether it's an integer, a float or malformed. Updates the position
+    /// to point to the first character after the number.
+    ///
+    /// @return A view of the next numeric value in the input string.
+    std::string_view getNextNumber() {
+        size_t start = position;
+        position = advance<charscan::isNumberChar, 16>(charscan::active->scanNumber);
+        return lexeme(start);
+    }
+
+    /// @brief Lexes a numeric literal and converts its value.
+    ///
+    /// The literal is an Integer without a decimal point and a Float with
+    /// one, its value is parsed here with std::from_chars so no later stage
+    /// has to parse the text again. Integers too large for int64_t saturate,
+    /// floats too large become infinity, and a run with more than one point
+    /// such as 1.2.3 becomes an Unknown token. Each of those is reported.
+    /// Floats too small even for a denormal become 0, which is no error.
+    /// Without Traits::lexemes values aren't stored, but literals long enough
+    /// to be out of range are still converted, so every configuration
+    /// reports the same problems.
+    ///
+    /// @param token Receives the literal.
+    void lexNumber(Token& token);
+
+    /// @brief Adds the value of a literal token to the constant pool.
+    ///
+    /// @param token A lexed literal, gets the index of its value as id.
+    ///        Other tokens, such as malformed numbers, are left alone.
+    void addConstant(Token& token);
+
+    /// @brief Decodes the character after a backslash in a string literal.
+    ///
+    /// @param c The escaped character.
+    ///
+    /// @return The character the escape stands for, or -1 if it isn't one.
+    static int unescape(char c) {
+        switch (c) {
+            case 'n':
+                return '\n';
+            case 't':
+                return '\t';
+            case 'r':
+                return '\r';
+            case '0':
+                return '\0';
+            case '\\':
+            case '"':
+            case '\'':
+                return c;
+            default:
+                return -1;
+        }
+    }
+
+    /// @brief Returns the contents of a string literal, decoding escapes into a buffer.
+    ///
+    /// @param token A String token from this lexer.
+    /// @param buffer Called with a size only for a literal with escapes,
+    ///        returns room for that many bytes to decode into.
+    ///
+    /// @return A view of the source between the quotes, or of the decoded
+    ///         contents in the buffer.
+    template <typename Buffer>
+    static std::string_view decodeString(const Token& token, Buffer buffer);
+
+    /// @brief Lexes a string literal starting at the opening quote.
+    ///
+    /// The scanStringBody kernel jumps straight to the next quote, backslash
+    /// or newline, so only escapes and the terminator are looked at one byte
+    /// at a time. The token is the raw text including both quotes, see
+    /// stringValue() for the decoded contents. An unknown escape is reported
+    /// and kept, a literal still open at a newline or the input end is
+    /// reported and ends there, leaving the newline to the next token.
+    ///
+    /// @param token Receives the literal.
+    void lexString(Token& token);
+
+    /// @brief Skips a comment if one starts at the current position.
+    ///
+    /// A line comment runs up to its newline, which is left to be skipped as
+    /// whitespace, a block comment up to and including the closing */. Both
+    /// are found with the findByte kernel rather than a test per byte.
+    ///
+    /// @return False if the current position doesn't start a comment.
+    bool skipComment();
+
+    /// @brief Records a diagnostic for the input from start up to the current position.
+    ///
+    /// @param start The offset of the first offending character.
+    /// @param message A static description of the problem.
+    ///
+    /// @throws LexError In ErrorMode::FailFast, located by line and column.
+    void report(size_t start, const char* message);
+
+    /// @brief Moves to the start of the next token.
+    ///
+    /// Skips whitespace and comments, and unless unexpected characters become
+    /// Unknown tokens also skips each run of them, reporting the run as one
+    /// problem so garbage input costs one diagnostic rather than one token
+    /// per byte.
+    ///
+    /// @return False if the input ended first.
+    bool skipToToken();
+
+    /// @brief Moves the tracked location over the newlines in [from, position).
+    ///
+    /// Only whitespace and block comments can hold newlines, so those are
+    /// the only places that call this. Compiles to nothing unless
+    /// Traits::trackLocations is set.
+    ///
+    /// @param from The offset the skipped bytes start at.
+    void trackLines(size_t from);
+
+    /// @brief Runs a charscan kernel from the current position.
+    ///
+    /// The kernels work a vector register at a time, so long runs of
+    /// whitespace, identifier or digit characters cost a few loads instead
+    /// of one comparison chain per byte. Short runs never reach them, see
+    /// charscan::scan().
+    ///
+    /// @tparam InClass The byte test the kernel vectorizes.
+    /// @param kernel The scanning kernel to run.
+    ///
+    /// @return The offset of the first character the kernel stopped at.
+    template <bool (*InClass)(unsigned char), size_t Inline>
+    size_t advance(const char* (*kernel)(const char*, const char*)) const {
+        const char* begin = input.data();
+        return charscan::scan<InClass, Inline>(begin + position, begin + input.length(), kernel) - begin;
+    }
+
+    /// @brief Lexes every remaining token straight into the end of a vector.
+    ///
+    /// Each token is lexed into a slot made by emplace_back() instead of a
+    /// local that is then copied in, the one spare slot made at the input
+    /// end, or when lexing throws, is removed again.
+    ///
+    /// @param tokens A std::vector or TokenList of Token.
+    template <typename Tokens>
+    void emplaceTokens(Tokens& tokens);
+
+    /// @brief Guesses how many tokens the rest of the input holds.
+    ///
+    /// The generated benchmark corpora average 5 to 10 bytes per token, only
+    /// operator dense code goes below 4, so one token per 4 bytes keeps most
+    /// streams to a single allocation. Reserved but untouched capacity costs
+    /// address space rather than resident memory.
+    ///
+    /// @return The estimated token count from the current position on.
+    size_t estimateTokenCount() const {
+        return (input.length() - position) / 4 + 16;
+    }
+
+    /// @brief Returns a view of the input from start up to the current position.
+    ///
+    /// @param start The offset of the first character of the lexeme.
+    ///
+    /// @return A view into the input buffer, no characters are copied.
+    std::string_view lexeme(size_t start) const {
+        return input.substr(start, position - start);
+    }
+
+    public:
+    /// @brief Constructor for Lexer.
+    ///
+    /// Initializes the lexer with the given input string and initializes
+    /// the position to 0. Keywords come from the shared keywords::table,
+    /// so no per-instance setup is needed.
+    ///
+    /// @param input The string to be lexically analyzed.
+    BasicLexer(const std::string& input) : BasicLexer(SourceBuffer::fromString(input)) {
+    }
+
+    /// @brief Constructor for Lexer over an already loaded source.
+    ///
+    /// Takes ownership of the buffer and lexes its bytes in place.
+    ///
+    /// @param source The source text to be lexically analyzed.
+    explicit BasicLexer(SourceBuffer source) : source(std::move(source)), position(0) {
+        input = this->source.view();
+    }
+
+    /// @brief Creates a Lexer reading directly from a file.
+    ///
+    /// The file is memory mapped where the platform allows it, so the
+    /// program text is never copied into a string first.
+    ///
+    /// @param path The source file to be lexically analyzed.
+    ///
+    /// @return A Lexer positioned at the start of the file.
+    ///
+    /// @throws std::runtime_error If the file can't be opened or read.
+    static BasicLexer fromFile(const std::string& path) {
+        if constexpr (instrumentation::enabled) {
+            auto begin = std::chrono::steady_clock::now();
+            BasicLexer lexer(SourceBuffer::fromFile(path));
+            lexer.recorder.addTime(LexerPhase::Load,
+                                   std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+            return lexer;
+        } else {
+            return BasicLexer(SourceBuffer::fromFile(path));
+        }
+    }
+
+    /// @brief Rebinds the lexer to a new source.
+    ///
+    /// Lets one Lexer be reused for file after file. Nothing it holds is
+    /// freed: the diagnostics vector, the line index and the arena keep
+    /// their memory, so once they have grown to fit the largest source,
+    /// lexing into a reused TokenBuffer or vector allocates nothing further.
+    /// Tokens, token lists from the arena and diagnostics from the previous
+    /// source are invalidated. The error mode and symbol table stay as set.
+    ///
+    /// @param source The source text to be lexically analyzed next, borrowed
+    ///        or mapped to avoid copying it.
+    void reset(SourceBuffer source) {
+        this->source = std::move(source);
+        input = this->source.view();
+        position = 0;
+        problems.clear();
+        linesIndexed = false;
+        line = 1;
+        lineBegin = 0;
+        resetArena();
+    }
+
+    // tokens hold views into the source, a SourceBuffer keeps its bytes in
+    // place when moved but a copy would leave them pointing at the original
+    BasicLexer(const BasicLexer&) = delete;
+    BasicLexer& operator=(const BasicLexer&) = delete;
+    BasicLexer(BasicLexer&&) = default;
+    BasicLexer& operator=(BasicLexer&&) = default;
+
+    /// @brief Lexes the next token from the input string.
+    ///
+    /// Skips any whitespace at the current position and then scans exactly
+    /// one lexical unit, leaving the position just past it. The first
+    /// character picks the kind of unit through the charclass table. This is the pull
+    /// interface a parser can drive directly, only the current token is ever
+    /// held in memory.
+    ///
+    /// @param token Receives the next token, untouched at the end of input.
+    ///
+    /// @return True if a token was produced, false once the input is exhausted.
+    ///
+    /// @throws LexError In ErrorMode::FailFast, at the first problem found.
+    bool nextToken(Token& token);
+
+    /// @brief Input iterator that pulls tokens from a Lexer on demand.
+    ///
+    /// Incrementing the iterator calls nextToken(), so a range-for over
+    /// Lexer::tokens() lexes lazily. A default constructed iterator is the
+    /// end of the stream.
+    class TokenIterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Token;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Token*;
+        using reference = const Token&;
+
+        TokenIterator() : lexer(nullptr) {
+        }
+
+        explicit TokenIterator(BasicLexer* lexer) : lexer(lexer) {
+            ++*this;
+        }
+
+        const Token& operator*() const {
+            return token;
+        }
+
+        const Token* operator->() const {
+            return &token;
+        }
+
+        TokenIterator& operator++() {
+            if (!lexer->nextToken(token)) {
+                lexer = nullptr;
+            }
+            return *this;
+        }
+
+        bool operator==(const TokenIterator& other) const {
+            return lexer == other.lexer;
+        }
+
+        bool operator!=(const TokenIterator& other) const {
+            return lexer != other.lexer;
+        }
+
+    private:
+        BasicLexer* lexer;
+        Token token;
+    };
+
+    //range over the tokens still left in a Lexer, for use in range-for
+    struct TokenRange {
+        BasicLexer* lexer;
+
+        TokenIterator begin() const {
+            return TokenIterator(lexer);
+        }
+
+        TokenIterator end() const {
+            return TokenIterator();
+        }
+    };
+
+    /// @brief Returns a lazily lexed range over the remaining tokens.
+    ///
+    /// @return A range whose iteration drives nextToken().
+    TokenRange tokens() {
+        return TokenRange{this};
+    }
+
+    /// @brief Tokenizes the input string into a sequence of Tokens.
+    ///
+    /// Scans the input string and breaks it up into a sequence of Tokens,
+    /// where each Token represents a single lexical unit such as a keyword,
+    /// identifier, string literal, numeric literal, or symbol. This is a
+    /// convenience wrapper collecting everything nextToken() produces.
+    ///
+    /// @return A vector of Tokens representing the input string.
+    ///
+    std::vector<Token> tokenize() {
+        std::vector<Token> tokens;
+        tokenize(tokens);
+        return tokens;
+    }
+
+    /// @brief Lexes every remaining token into a sink.
+    ///
+    /// The loop is instantiated per sink type, so calling the sink costs no
+    /// indirection. With Traits::trackLocations the sink also gets where
+    /// the token starts.
+    ///
+    /// @param sink Called as sink(token), or sink(token, location) when
+    ///        locations are tracked, for each token in order.
+    template <typename Sink>
+    void lex(Sink&& sink) {
+        [[maybe_unused]] auto timer = recorder.time(LexerPhase::Tokenize);
+        Token token;
+        while (nextToken(token)) {
+            if constexpr (Traits::trackLocations) {
+                sink(static_cast<const Token&>(token), SourceLocation{line, token.offset - lineBegin + 1});
+            } else {
+                sink(static_cast<const Token&>(token));
+            }
+        }
+    }
+
+    /// @brief Tokenizes the input string into a caller-owned vector.
+    ///
+    /// Appends every remaining token to tokens. Clearing and passing the same
+    /// vector for each source keeps its capacity, so repeated runs stop
+    /// allocating once it fits the largest stream.
+    ///
+    /// @param tokens The vector the tokens are appended to.
+    void tokenize(std::vector<Token>& tokens);
+
+    /// @brief Tokenizes the input string into tokens that own their lexemes.
+    ///
+    /// Each token is constructed in place from the lexer's view, copying its
+    /// lexeme exactly once, so the result outlives the Lexer and its source.
+    ///
+    /// @param tokens The vector the tokens are appended to.
+    void tokenize(std::vector<OwnedToken>& tokens);
+
+    /// @brief Tokenizes the input string into a structure-of-arrays buffer.
+    ///
+    /// Appends every remaining token to buffer as a type, offset and length
+    /// triple relative to text(), without building a Token vector first.
+    ///
+    /// @param buffer The buffer the tokens are appended to.
+    ///
+    /// @throws std::length_error If the input is too large for 32-bit offsets.
+    void tokenize(TokenBuffer& buffer);
+
+    /// @brief Tokenizes the input string into a list living in the lexer's arena.
+    ///
+    /// The list is pre-sized from estimateTokenCount() and allocated from
+    /// arena(), so the whole token stream is given back in one shot by
+    /// resetArena() instead of through one free per allocation.
+    ///
+    /// @return The tokens, valid until resetArena() or the Lexer is destroyed.
+    TokenList tokenizeInArena();
+
+    /// @brief Returns the monotonic arena owned by this lexer.
+    ///
+    /// Holds token lists from tokenizeInArena() and any lexeme that has to be
+    /// materialized rather than viewed in the source.
+    ///
+    /// @return The arena, created on first use.
+    Arena& arena() {
+        if (!storage) {
+            storage = std::make_unique<Arena>();
+        }
+        return *storage;
+    }
+
+    /// @brief Frees everything allocated from the arena at once.
+    ///
+    /// The arena keeps its blocks for the next tokenizeInArena(). Every
+    /// TokenList and lexeme taken from it before is invalidated.
+    void resetArena() {
+        if (storage) {
+            storage->reset();
+        }
+    }
+
+    /// @brief Returns the contents of a string literal with its escapes decoded.
+    ///
+    /// A literal without a backslash is returned as a view of the source
+    /// between its quotes, only one with escapes is decoded into arena().
+    /// Unknown escapes are kept as written.
+    ///
+    /// @param token A String token from this lexer.
+    ///
+    /// @return The contents, valid until resetArena() or the Lexer is destroyed.
+    std::string_view stringValue(const Token& token);
+
+    /// @brief Attaches a constant pool literals are added to.
+    ///
+    /// With a pool attached every Integer, Float and String token carries
+    /// the index of its value in the pool for its type, which also fills the
+    /// id column of a TokenBuffer. Strings are pooled decoded, see
+    /// stringValue(). Ignored without Traits::lexemes.
+    ///
+    /// @param pool The pool to add to, or nullptr to stop pooling. It must
+    ///        outlive its use by this lexer.
+    void setConstantPool(ConstantPool* pool) {
+        constants = pool;
+    }
+
+    /// @brief Attaches a symbol table identifiers are interned into.
+    ///
+    /// With a table attached every identifier token carries the dense id of
+    /// its name, which also fills the id column of a TokenBuffer. Ignored
+    /// without Traits::lexemes.
+    ///
+    /// @param table The table to intern into, or nullptr to stop interning.
+    ///        It must outlive its use by this lexer.
+    void setSymbolTable(SymbolTable* table) {
+        symbols = table;
+    }
+
+    /// @brief Chooses how unexpected characters and other problems are handled.
+    ///
+    /// @param errorMode The mode, ErrorMode::Tokens unless set.
+    void setErrorMode(ErrorMode errorMode) {
+        mode = errorMode;
+    }
+
+    ErrorMode errorMode() const {
+        return mode;
+    }
+
+    /// @brief Returns the problems found in the input so far.
+    ///
+    /// @return The diagnostics in source order.
+    const std::vector<Diagnostic>& diagnostics() const {
+        return problems;
+    }
+
+    /// @brief Returns what this lexer has counted so far.
+    ///
+    /// Counters accumulate across reset() until clearStats().
+    ///
+    /// @return The counters, all zero unless built with LEXER_INSTRUMENTATION.
+    const LexerStats& stats() const {
+        return recorder.stats();
+    }
+
+    void clearStats() {
+        recorder.clear();
+    }
+
+    /// @brief Returns the line index of the input, building it on first use.
+    ///
+    /// @return The index, valid until reset().
+    const LineIndex& lines() {
+        if (!linesIndexed) {
+            lineIndex.rebuild(input);
+            linesIndexed = true;
+        }
+        return lineIndex;
+    }
+
+    /// @brief Returns the line and column of a byte offset, e.g. Token::offset.
+    ///
+    /// @param offset An offset into the input.
+    ///
+    /// @return The location. Offsets on the current line are answered from
+    ///         the tracked location with Traits::trackLocations, others by
+    ///         the line index, which the first such call builds.
+    SourceLocation locate(size_t offset) {
+        if constexpr (Traits::trackLocations) {
+            if (offset >= lineBegin && offset <= position) {
+                return SourceLocation{line, offset - lineBegin + 1};
+            }
+        }
+        return lines().locate(offset);
+    }
+
+    /// @brief Moves the lexer to a byte offset in the input.
+    ///
+    /// Lexing resumes from offset as if it were the start of the input, so it
+    /// should be a position where a token or whitespace begins.
+    ///
+    /// @param offset The offset to continue from, clamped to the input length.
+    ///        Tracked locations are recounted from the current position, or
+    ///        from the input start when seeking backwards.
+    void seek(size_t offset) {
+        offset = offset < input.length() ? offset : input.length();
+        if constexpr (Traits::trackLocations) {
+            if (offset < position) {
+                position = 0;
+                line = 1;
+                lineBegin = 0;
+            }
+            size_t from = position;
+            position = offset;
+            trackLines(from);
+        } else {
+            position = offset;
+        }
+    }
+
+    /// @brief Returns the byte offset lexing will continue from.
+    ///
+    /// @return The current position in the input.
+    size_t offset() const {
+        return position;
+    }
+
+    /// @brief Returns the source text being lexed.
+    ///
+    /// @return A view of the whole input, valid for the lifetime of the Lexer.
+    std::string_view text() const {
+        return input;
+    }
+};
+
+//the lexer used for compilation, with every feature of LexerTraits
+using Lexer = BasicLexer<>;
+
+//the lexer used for highlighting, see HighlightTraits
+using HighlightLexer = BasicLexer<HighlightTraits>;
+
+//the lexing loop itself is defined in LexerImpl.h. With LEXER_LIBRARY
+//defined both configurations are compiled once, in src/Lexer.cpp, and files
+//including this one neither see nor instantiate it, they have to be linked
+//with the library instead. Build both with the same LEXER_ flags. A
+//configuration of its own needs LexerImpl.h included after this file.
+#ifdef LEXER_LIBRARY
+extern template class BasicLexer<LexerTraits>;
+extern template class BasicLexer<HighlightTraits>;
+#else
+#include "LexerImpl.h"
+#endif
@@ -0,0 +1,367 @@
+#pragma once
+
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "Lexer.h"
+
+//out-of-line definitions of the BasicLexer members that do the lexing,
+//documented where they are declared. Lexer.h includes this unless it is
+//built against the library, where src/Lexer.cpp compiles them once.
+
+template <typename Traits>
+void BasicLexer<Traits>::continueUnicodeWord() {
+    for (size_t length; position < input.length() && (length = unicodeAt(position, utf8::isIdentifierContinue)) != 0;) {
+        position += length;
+        position = advance<charscan::isAlphaNumeric, 0>(charscan::active->scanAlphaNumeric);
+    }
+}
+
+template <typename Traits>
+size_t BasicLexer<Traits>::unicodeAt(size_t offset, bool (*property)(uint32_t)) const {
+    uint32_t codePoint;
+    size_t length = utf8::decode(input.data() + offset, input.data() + input.length(), codePoint);
+    return length != 0 && property(codePoint) ? length : 0;
+}
+
+template <typename Traits>
+size_t BasicLexer<Traits>::characterLength(size_t offset) const {
+    uint32_t codePoint;
+    size_t length = utf8::decode(input.data() + offset, input.data() + input.length(), codePoint);
+    return length != 0 ? length : 1;
+}
+
+template <typename Traits>
+inline void BasicLexer<Traits>::lexNumber(Token& token) {
+    [[maybe_unused]] auto timer = recorder.time(LexerPhase::Numbers);
+    size_t start = position;
+    std::string_view number = getNextNumber();
+    const char* first = number.data();
+    const char* last = first + number.length();
+    size_t point = number.find('.');
+    if (point == std::string_view::npos) {
+        token = Token(TokenType::Integer, number);
+        //shorter literals always fit, so only those need converting without lexemes
+        if (Traits::lexemes || number.length() > std::numeric_limits<int64_t>::digits10) {
+            int64_t value = 0;
+            if (std::from_chars(first, last, value).ec == std::errc::result_out_of_range) {
+                value = std::numeric_limits<int64_t>::max();
+                report(start, "integer literal out of range");
+            }
+            if constexpr (Traits::lexemes) {
+                token.intValue = value;
+            }
+        }
+    } else if (number.find('.', point + 1) != std::string_view::npos) {
+        token = Token(TokenType::Unknown, number);
+        report(start, "malformed number literal, more than one decimal point");
+    } else {
+        token = Token(TokenType::Float, number);
+        //without an exponent, a literal shorter than this can neither
+        //overflow nor underflow a double
+        if (Traits::lexemes || number.length() >= static_cast<size_t>(std::numeric_limits<double>::max_exponent10)) {
+            double value = 0;
+            if (std::from_chars(first, last, value).ec == std::errc::result_out_of_range) {
+                //literals are unsigned without an exponent, so one out of
+                //range below 1 has only zeros before the point
+                if (number.find_first_not_of('0') == point) {
+                    value = 0;
+                } else {
+                    value = std::numeric_limits<double>::infinity();
+                    report(start, "float literal out of range");
+                }
+            }
+            if constexpr (Traits::lexemes) {
+                token.floatValue = value;
+            }
+        }
+    }
+}
+
+template <typename Traits>
+inline void BasicLexer<Traits>::addConstant(Token& token) {
+    [[maybe_unused]] auto timer = recorder.time(LexerPhase::Intern);
+    size_t known = constants->size();
+    switch (token.type) {
+        case TokenType::Integer:
+            token.id = constants->addInteger(token.intValue);
+            break;
+        case TokenType::Float:
+            token.id = constants->addFloat(token.floatValue);
+            break;
+        case TokenType::String:
+            token.id = constants->addString(decodeString(token, [this](size_t size) {
+                scratch.resize(size);
+                return scratch.data();
+            }));
+            break;
+        default:
+            break;
+    }
+    recorder.countAllocations(constants->size() - known);
+}
+
+template <typename Traits>
+inline void BasicLexer<Traits>::lexString(Token& token) {
+    size_t start = position++;
+    while (true) {
+        position = advance<charscan::isStringBody, 0>(charscan::active->scanStringBody);
+        if (position == input.length() || input[position] == '\n') {
+            report(start, "unterminated string literal");
+            break;
+        }
+        if (input[position] == '"') {
+            position++;
+            break;
+        }
+        size_t escape = position;
+        if (position + 1 == input.length() || input[position + 1] == '\n') {
+            position++;
+            continue;
+        }
+        position += 2;
+        if (unescape(input[escape + 1]) < 0) {
+            report(escape, "unknown escape sequence");
+        }
+    }
+    token = Token(TokenType::String, lexeme(start));
+}
+
+template <typename Traits>
+inline bool BasicLexer<Traits>::skipComment() {
+    if (input[position] != '/' || position + 1 >= input.length()) {
+        return false;
+    }
+    const char* begin = input.data();
+    const char* end = begin + input.length();
+    size_t start = position;
+    if (input[position + 1] == '/') {
+        position = charscan::active->findByte(begin + position + 2, end, '\n') - begin;
+    } else if (input[position + 1] == '*') {
+        const char* p = begin + position + 2;
+        while ((p = charscan::active->findByte(p, end, '*')) != end && (p + 1 == end || p[1] != '/')) {
+            ++p;
+        }
+        position = p == end ? input.length() : p + 2 - begin;
+        recorder.countBytes(CharClass::Whitespace, position - start);
+        if (p == end) {
+            report(start, "unterminated block comment");
+        }
+        trackLines(start);
+        return true;
+    } else {
+        return false;
+    }
+    recorder.countBytes(CharClass::Whitespace, position - start);
+    return true;
+}
+
+template <typename Traits>
+inline void BasicLexer<Traits>::report(size_t start, const char* message) {
+    Diagnostic problem = {start, position - start, message};
+    if (mode == ErrorMode::FailFast) {
+        SourceLocation where = locate(start);
+        throw LexError(problem, std::to_string(where.line) + ":" + std::to_string(where.column));
+    }
+    problems.push_back(problem);
+}
+
+template <typename Traits>
+inline bool BasicLexer<Traits>::skipToToken() {
+    while (true) {
+        size_t skipped = position;
+        position = advance<charscan::isWhitespace, 1>(charscan::active->skipWhitespace);
+        recorder.countBytes(CharClass::Whitespace, position - skipped);
+        trackLines(skipped);
+        if (position >= input.length()) {
+            return false;
+        }
+        if (skipComment()) {
+            continue;
+        }
+        if (mode == ErrorMode::Tokens || unexpectedAt(position) == 0) {
+            return true;
+        }
+        size_t start = position;
+        for (size_t length; position < input.length() && (length = unexpectedAt(position)) != 0;) {
+            position += length;
+        }
+        recorder.countBytes(CharClass::Other, position - start);
+        report(start, "unexpected characters");
+    }
+}
+
+template <typename Traits>
+inline void BasicLexer<Traits>::trackLines(size_t from) {
+    if constexpr (Traits::trackLocations) {
+        const char* begin = input.data();
+        const char* end = begin + position;
+        for (const char* p = begin + from; (p = charscan::active->findByte(p, end, '\n')) != end;) {
+            line++;
+            lineBegin = ++p - begin;
+        }
+    }
+}
+
+template <typename Traits>
+template <typename Tokens>
+inline void BasicLexer<Traits>::emplaceTokens(Tokens& tokens) {
+    try {
+        do {
+            recorder.countAllocations(tokens.size() == tokens.capacity());
+        } while (nextToken(tokens.emplace_back()));
+    } catch (...) {
+        tokens.pop_back();
+        throw;
+    }
+    tokens.pop_back();
+}
+
+template <typename Traits>
+inline bool BasicLexer<Traits>::nextToken(Token& token) {
+    if (!skipToToken()) {
+        return false;
+    }
+
+    size_t start = position;
+    CharClass charClass = Traits::classify(input[position]);
+    switch (charClass) {
+        case CharClass::Utf8:
+            if (unicodeAt(position, utf8::isIdentifierStart) == 0) {
+                position += characterLength(position);
+                token = Token(TokenType::Unknown, lexeme(start));
+                break;
+            }
+            [[fallthrough]];
+        case CharClass::Letter: {
+            std::string_view word = getNextWord();
+            KeywordKind keyword = KeywordKind::None;
+            if constexpr (!Traits::Keywords::empty) {
+                keyword = Traits::Keywords::lookup(word);
+                recorder.countKeywordLookup(keyword != KeywordKind::None);
+            }
+            if (keyword != KeywordKind::None) {
+                token = Token(TokenType::Keyword, word);
+                token.keywordKind = keyword;
+            } else {
+                uint32_t id = Token::noId;
+                if (Traits::lexemes && symbols != nullptr) {
+                    [[maybe_unused]] auto timer = recorder.time(LexerPhase::Intern);
+                    size_t known = symbols->size();
+                    id = symbols->intern(word);
+                    recorder.countAllocations(symbols->size() - known);
+                }
+                token = Token(TokenType::Identifier, word, id);
+            }
+            break;
+        }
+        case CharClass::Digit:
+            lexNumber(token);
+            if (Traits::lexemes && constants != nullptr) {
+                addConstant(token);
+            }
+            break;
+        // Operators and delimiters, longest spelling first so <<= beats <<
+        case CharClass::Operator:
+        case CharClass::Delimiter: {
+            const char* begin = input.data();
+            operators::Match match = operators::match(begin + position, begin + input.length());
+            position += match.length;
+            token = Token(operators::typeOf(match.kind), lexeme(start));
+            token.operatorKind = match.kind;
+            break;
+        }
+        case CharClass::Quote:
+            lexString(token);
+            if (Traits::lexemes && constants != nullptr) {
+                addConstant(token);
+            }
+            break;
+        default:
+            position++;
+            token = Token(TokenType::Unknown, lexeme(start));
+            break;
+    }
+    token.offset = start;
+    recorder.countToken(token.type);
+    recorder.countBytes(charClass, position - start);
+    return true;
+}
+
+template <typename Traits>
+inline void BasicLexer<Traits>::tokenize(std::vector<Token>& tokens) {
+    [[maybe_unused]] auto timer = recorder.time(LexerPhase::Tokenize);
+    size_t wanted = tokens.size() + estimateTokenCount();
+    recorder.countAllocations(tokens.capacity() < wanted);
+    tokens.reserve(wanted);
+    emplaceTokens(tokens);
+}
+
+template <typename Traits>
+inline void BasicLexer<Traits>::tokenize(std::vector<OwnedToken>& tokens) {
+    [[maybe_unused]] auto timer = recorder.time(LexerPhase::Tokenize);
+    Token token;
+    while (nextToken(token)) {
+        tokens.emplace_back(token);
+    }
+}
+
+template <typename Traits>
+inline void BasicLexer<Traits>::tokenize(TokenBuffer& buffer) {
+    if (input.length() > UINT32_MAX) {
+        throw std::length_error("source too large for a TokenBuffer, offsets are 32-bit");
+    }
+    [[maybe_unused]] auto timer = recorder.time(LexerPhase::Tokenize);
+    //the columns are sized together, so a growth allocates once per column
+    size_t columns = buffer.hasIds() ? 5 : 4;
+    size_t wanted = buffer.size() + estimateTokenCount();
+    recorder.countAllocations(buffer.capacity() < wanted ? columns : 0);
+    buffer.reserve(wanted);
+    Token token;
+    while (nextToken(token)) {
+        recorder.countAllocations(buffer.size() == buffer.capacity() ? columns : 0);
+        buffer.push(token.type, static_cast<uint32_t>(token.offset), static_cast<uint32_t>(token.value.length()), token.id,
+                    token.kindByte());
+    }
+}
+
+template <typename Traits>
+inline TokenList BasicLexer<Traits>::tokenizeInArena() {
+    [[maybe_unused]] auto timer = recorder.time(LexerPhase::Tokenize);
+    TokenList tokens(&arena());
+    tokens.reserve(estimateTokenCount());
+    recorder.countAllocations(1);
+    emplaceTokens(tokens);
+    return tokens;
+}
+
+template <typename Traits>
+template <typename Buffer>
+inline std::string_view BasicLexer<Traits>::decodeString(const Token& token, Buffer buffer) {
+    std::string_view body = token.value.substr(1);
+    const char* backslash = static_cast<const char*>(std::memchr(body.data(), '\\', body.size()));
+    if (backslash == nullptr) {
+        return !body.empty() && body.back() == '"' ? body.substr(0, body.size() - 1) : body;
+    }
+    char* decoded = buffer(body.size());
+    size_t length = backslash - body.data();
+    std::memcpy(decoded, body.data(), length);
+    for (size_t i = length; i < body.size(); i++) {
+        int c = body[i] == '\\' && i + 1 < body.size() ? unescape(body[i + 1]) : -1;
+        if (c >= 0) {
+            decoded[length++] = static_cast<char>(c);
+            i++;
+        } else if (body[i] != '"' || i + 1 != body.size()) {
+            decoded[length++] = body[i];
+        }
+    }
+    return std::string_view(decoded, length);
+}
+
+template <typename Traits>
+inline std::string_view BasicLexer<Traits>::stringValue(const Token& token) {
+    return decodeString(token, [this](size_t size) { return static_cast<char*>(arena().allocate(size, 1)); });
+}
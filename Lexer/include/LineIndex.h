@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "CharScan.h"
+
+//a line and column in a source, both counted from 1, columns in bytes
+struct SourceLocation {
+    size_t line;
+    size_t column;
+};
+
+//byte offsets of every line start in a source
+//built in one pass of the vector newline kernel and only when a location is
+//actually asked for, so lexing itself never counts lines. Locating an offset
+//is then a binary search over the line starts.
+class LineIndex {
+private:
+    std::vector<size_t> starts;
+
+public:
+    //an index of no source yet, see rebuild()
+    LineIndex() = default;
+
+    /// @brief Constructor for LineIndex.
+    ///
+    /// @param source The text to index, only read during construction.
+    explicit LineIndex(std::string_view source) {
+        rebuild(source);
+    }
+
+    /// @brief Indexes another source, reusing the memory of the previous index.
+    ///
+    /// @param source The text to index, only read during the call.
+    void rebuild(std::string_view source) {
+        starts.clear();
+        starts.push_back(0);
+        const char* end = source.data() + source.size();
+        const char* p = source.data();
+        while ((p = charscan::active->findByte(p, end, '\n')) != end) {
+            ++p;
+            starts.push_back(p - source.data());
+        }
+    }
+
+    /// @brief Returns the line and column of a byte offset.
+    ///
+    /// @param offset An offset into the indexed source, the source length is
+    ///        allowed and locates the end of the input.
+    ///
+    /// @return The location of offset.
+    SourceLocation locate(size_t offset) const {
+        size_t line = std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin();
+        return SourceLocation{line, offset - starts[line - 1] + 1};
+    }
+
+    /// @brief Returns the number of lines, a trailing newline starts an empty last line.
+    size_t lineCount() const {
+        return starts.size();
+    }
+
+    /// @brief Returns the offset a line starts at.
+    ///
+    /// @param line The line, counted from 1.
+    size_t lineStart(size_t line) const {
+        return starts[line - 1];
+    }
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "CharClass.h"
+#include "Token.h"
+
+//operator and delimiter spellings and the trie that matches them, built at
+//compile time. Matching walks the trie one byte at a time and keeps the
+//longest spelling seen, so the longest operator is found in one pass without
+//backtracking and the token carries its OperatorKind rather than a string.
+namespace operators {
+    struct Entry {
+        std::string_view spelling;
+        OperatorKind kind;
+    };
+
+    constexpr Entry list[] = {
+        {"+", OperatorKind::Plus}, {"-", OperatorKind::Minus}, {"*", OperatorKind::Star},
+        {"/", OperatorKind::Slash}, {"%", OperatorKind::Percent}, {"=", OperatorKind::Assign},
+        {"==", OperatorKind::Equal}, {"!=", OperatorKind::NotEqual}, {"<", OperatorKind::Less},
+        {"<=", OperatorKind::LessEqual}, {">", OperatorKind::Greater}, {">=", OperatorKind::GreaterEqual},
+        {"<<", OperatorKind::ShiftLeft}, {">>", OperatorKind::ShiftRight}, {"<<=", OperatorKind::ShiftLeftAssign},
+        {">>=", OperatorKind::ShiftRightAssign}, {"&&", OperatorKind::LogicalAnd}, {"||", OperatorKind::LogicalOr},
+        {"!", OperatorKind::Not}, {"&", OperatorKind::BitAnd}, {"|", OperatorKind::BitOr},
+        {"^", OperatorKind::BitXor}, {"~", OperatorKind::BitNot}, {"+=", OperatorKind::PlusAssign},
+        {"-=", OperatorKind::MinusAssign}, {"*=", OperatorKind::StarAssign}, {"/=", OperatorKind::SlashAssign},
+        {"%=", OperatorKind::PercentAssign}, {"&=", OperatorKind::AndAssign}, {"|=", OperatorKind::OrAssign},
+        {"^=", OperatorKind::XorAssign}, {"++", OperatorKind::Increment}, {"--", OperatorKind::Decrement},
+        {"->", OperatorKind::Arrow}, {".", OperatorKind::Dot}, {"::", OperatorKind::Scope},
+        {"?", OperatorKind::Question}, {"(", OperatorKind::LeftParen}, {")", OperatorKind::RightParen},
+        {"[", OperatorKind::LeftBracket}, {"]", OperatorKind::RightBracket}, {"{", OperatorKind::LeftBrace},
+        {"}", OperatorKind::RightBrace}, {":", OperatorKind::Colon}, {";", OperatorKind::Semicolon},
+        {",", OperatorKind::Comma}
+    };
+
+    constexpr size_t kindCount = static_cast<size_t>(OperatorKind::Comma) + 1;
+
+    /// @brief Returns the token type of an operator kind.
+    ///
+    /// @param kind A kind other than None.
+    ///
+    /// @return Delimiter for brackets and separators, Operator otherwise.
+    constexpr TokenType typeOf(OperatorKind kind) {
+        return kind >= OperatorKind::LeftParen ? TokenType::Delimiter : TokenType::Operator;
+    }
+
+    //one node per distinct prefix of a spelling, node 0 is the empty prefix
+    //children are indexed by a dense symbol number instead of the raw byte,
+    //which keeps a node to a few dozen bytes
+    constexpr size_t alphabetCapacity = 32;
+    constexpr size_t nodeCapacity = 64;
+
+    struct Node {
+        uint8_t next[alphabetCapacity] = {};
+        OperatorKind kind = OperatorKind::None;
+    };
+
+    struct Trie {
+        //symbol number + 1 of every byte, 0 for bytes no spelling contains
+        uint8_t symbols[256] = {};
+        Node nodes[nodeCapacity] = {};
+        std::string_view spellings[kindCount] = {};
+        size_t symbolCount = 0;
+        size_t nodeCount = 1;
+        bool valid = true;
+    };
+
+    constexpr Trie build() {
+        Trie trie;
+        for (const Entry& entry : list) {
+            size_t node = 0;
+            for (char c : entry.spelling) {
+                uint8_t& symbol = trie.symbols[static_cast<unsigned char>(c)];
+                if (symbol == 0) {
+                    if (trie.symbolCount == alphabetCapacity) {
+                        trie.valid = false;
+                        return trie;
+                    }
+                    symbol = static_cast<uint8_t>(++trie.symbolCount);
+                }
+                uint8_t& child = trie.nodes[node].next[symbol - 1];
+                if (child == 0) {
+                    if (trie.nodeCount == nodeCapacity) {
+                        trie.valid = false;
+                        return trie;
+                    }
+                    child = static_cast<uint8_t>(trie.nodeCount++);
+                }
+                node = child;
+            }
+            if (trie.nodes[node].kind != OperatorKind::None) {
+                trie.valid = false;
+            }
+            trie.nodes[node].kind = entry.kind;
+            trie.spellings[static_cast<size_t>(entry.kind)] = entry.spelling;
+        }
+        return trie;
+    }
+
+    inline constexpr Trie trie = build();
+    static_assert(trie.valid, "operator list has a duplicate or outgrew the trie capacities");
+
+    //longest operator at the start of some input
+    struct Match {
+        OperatorKind kind;
+        size_t length;
+    };
+
+    /// @brief Finds the longest operator or delimiter starting at p.
+    ///
+    /// @param p The first byte to match.
+    /// @param end The end of the input.
+    ///
+    /// @return The kind and length of the match, None and 0 if there is none.
+    constexpr Match match(const char* p, const char* end) {
+        Match best = {OperatorKind::None, 0};
+        size_t node = 0;
+        for (size_t length = 1; p != end; ++p, ++length) {
+            uint8_t symbol = trie.symbols[static_cast<unsigned char>(*p)];
+            if (symbol == 0 || (node = trie.nodes[node].next[symbol - 1]) == 0) {
+                break;
+            }
+            if (trie.nodes[node].kind != OperatorKind::None) {
+                best = {trie.nodes[node].kind, length};
+            }
+        }
+        return best;
+    }
+
+    /// @brief Classifies a whole lexeme, e.g. one read back from a TokenBuffer.
+    ///
+    /// @param text The lexeme.
+    ///
+    /// @return Its kind, or None if text isn't exactly one operator or delimiter.
+    constexpr OperatorKind lookup(std::string_view text) {
+        Match found = match(text.data(), text.data() + text.size());
+        return found.length == text.size() ? found.kind : OperatorKind::None;
+    }
+
+    /// @brief Returns how an operator kind is written.
+    ///
+    /// @param kind The kind.
+    ///
+    /// @return A view of a static spelling, empty for None.
+    constexpr std::string_view spelling(OperatorKind kind) {
+        return trie.spellings[static_cast<size_t>(kind)];
+    }
+
+    /// @brief Checks that the character classes agree with the spellings.
+    ///
+    /// Every Operator or Delimiter byte has to start a one-byte spelling so
+    /// the lexer always makes progress, only those bytes may start one, and
+    /// every prefix of a spelling has to be a spelling itself. The last rule
+    /// means a match never rests on more than the byte after it, which
+    /// relex() relies on.
+    constexpr bool consistent() {
+        for (int c = 0; c < 256; c++) {
+            CharClass charClass = charclass::of(static_cast<char>(c));
+            bool starts = charClass == CharClass::Operator || charClass == CharClass::Delimiter;
+            char byte = static_cast<char>(c);
+            if (starts != (match(&byte, &byte + 1).length == 1)) {
+                return false;
+            }
+        }
+        for (const Entry& entry : list) {
+            for (size_t length = 1; length < entry.spelling.size(); length++) {
+                if (lookup(entry.spelling.substr(0, length)) == OperatorKind::None) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static_assert(consistent(), "charclass operators and delimiters must match the first bytes of operators::list");
+    static_assert(lookup("<<=") == OperatorKind::ShiftLeftAssign && lookup("->") == OperatorKind::Arrow
+                  && lookup("::") == OperatorKind::Scope && lookup("=>") == OperatorKind::None);
+    static_assert(match("a", "a" + 1).length == 0 && spelling(OperatorKind::LogicalAnd) == "&&");
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "CharClass.h"
+#include "Lexer.h"
+
+//token stream made of per-chunk segments, as produced by tokenizeParallel()
+//segments are kept as they come out of the workers, so indexing across them
+//needs no concatenation copy. flatten() builds one vector when that's wanted.
+class SegmentedTokens {
+private:
+    std::vector<std::vector<Token>> segments;
+    std::vector<size_t> starts;
+    size_t count = 0;
+    std::vector<Diagnostic> problems;
+
+public:
+    /// @brief Appends a segment, taking ownership of its tokens.
+    ///
+    /// @param tokens The tokens of the segment, in source order.
+    void append(std::vector<Token>&& tokens) {
+        if (tokens.empty()) {
+            return;
+        }
+        starts.push_back(count);
+        count += tokens.size();
+        segments.push_back(std::move(tokens));
+    }
+
+    /// @brief Appends the problems found in a segment.
+    ///
+    /// @param diagnostics Diagnostics following every one added so far in source order.
+    void appendDiagnostics(const std::vector<Diagnostic>& diagnostics) {
+        problems.insert(problems.end(), diagnostics.begin(), diagnostics.end());
+    }
+
+    /// @brief Returns the problems found in the source.
+    ///
+    /// @return The same diagnostics Lexer::tokenize() would have collected, in source order.
+    const std::vector<Diagnostic>& diagnostics() const {
+        return problems;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    size_t segmentCount() const {
+        return segments.size();
+    }
+
+    const std::vector<Token>& segment(size_t index) const {
+        return segments[index];
+    }
+
+    /// @brief Returns a token by its index in the whole stream.
+    ///
+    /// @param index The position of the token across all segments.
+    ///
+    /// @return The token, found with a binary search over segment starts.
+    const Token& operator[](size_t index) const {
+        size_t segmentIndex = std::upper_bound(starts.begin(), starts.end(), index) - starts.begin() - 1;
+        return segments[segmentIndex][index - starts[segmentIndex]];
+    }
+
+    /// @brief Concatenates every segment into a single vector.
+    ///
+    /// @return All tokens in source order.
+    std::vector<Token> flatten() const {
+        std::vector<Token> tokens;
+        tokens.reserve(count);
+        for (const std::vector<Token>& tokensInSegment : segments) {
+            tokens.insert(tokens.end(), tokensInSegment.begin(), tokensInSegment.end());
+        }
+        return tokens;
+    }
+};
+
+//splits large inputs into chunks lexed on several threads
+//chunk boundaries are placed right after a whitespace run, where a token
+//normally starts. A boundary can still land inside a lexeme that spans
+//whitespace, so each chunk is checked against where its predecessor really
+//stopped and re-lexed sequentially from there if the two disagree.
+namespace parallel {
+    //inputs smaller than this per thread are not worth splitting
+    constexpr size_t minChunkSize = 256 * 1024;
+
+    //what one worker produced for one chunk
+    struct Chunk {
+        size_t begin = 0;
+        size_t boundary = 0;
+        size_t end = 0;
+        std::vector<Token> tokens;
+        std::vector<Diagnostic> problems;
+        //set if lexing the chunk threw, e.g. a LexError in fail-fast mode
+        std::exception_ptr error;
+    };
+
+    /// @brief Finds the first token-start candidate at or after offset.
+    ///
+    /// @param source The whole source text.
+    /// @param offset The nominal split point.
+    ///
+    /// @return The first offset that follows whitespace and isn't whitespace
+    ///         itself, or the source length if there is none.
+    inline size_t findBoundary(std::string_view source, size_t offset) {
+        while (offset < source.size() && charclass::of(source[offset]) != CharClass::Whitespace) {
+            offset++;
+        }
+        while (offset < source.size() && charclass::of(source[offset]) == CharClass::Whitespace) {
+            offset++;
+        }
+        return offset;
+    }
+
+    /// @brief Lexes the tokens that start in [begin, boundary).
+    ///
+    /// @param lexer A lexer over the whole source.
+    /// @param chunk Receives the tokens and the problems found before
+    ///        boundary, and in end the offset lexing stopped at: the start of
+    ///        the first token or skipped run past boundary, or the input end.
+    ///        An exception from the lexer is kept in error instead of
+    ///        propagating.
+    inline void lexChunk(Lexer& lexer, Chunk& chunk) {
+        lexer.seek(chunk.begin);
+        Token token;
+        chunk.tokens.clear();
+        chunk.problems.clear();
+        chunk.error = nullptr;
+        chunk.end = lexer.text().size();
+        size_t known = lexer.diagnostics().size();
+        try {
+            while (lexer.nextToken(token)) {
+                if (token.offset >= chunk.boundary) {
+                    chunk.end = token.offset;
+                    break;
+                }
+                chunk.tokens.push_back(token);
+                //a token starting before boundary owns its problems wherever
+                //they are, e.g. a bad escape late in a long string literal
+                chunk.problems.insert(chunk.problems.end(), lexer.diagnostics().begin() + known, lexer.diagnostics().end());
+                known = lexer.diagnostics().size();
+            }
+        } catch (...) {
+            chunk.error = std::current_exception();
+        }
+        //problems past boundary belong to the next chunk, which finds them
+        //again, a skipped run there is where lexing stopped like a token is
+        for (size_t i = known; i < lexer.diagnostics().size(); i++) {
+            const Diagnostic& problem = lexer.diagnostics()[i];
+            if (problem.offset < chunk.boundary) {
+                chunk.problems.push_back(problem);
+            } else {
+                chunk.end = std::min(chunk.end, problem.offset);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Tokenizes a source on several threads.
+ *
+ * Produces the same token stream and diagnostics as Lexer::tokenize() over
+ * the same text. Tokens view source directly, so it must outlive the result.
+ *
+ * @param source The text to tokenize.
+ * @param threads The number of worker threads, 0 for one per core.
+ * @param mode How the lexers handle unexpected characters and problems.
+ * @param chunkSize The smallest input worth a chunk of its own, small values
+ *        force many chunk boundaries, e.g. to cross-check the resync.
+ *
+ * @return The tokens, one segment per chunk.
+ *
+ * @throws LexError In ErrorMode::FailFast, the first problem in source order.
+ */
+inline SegmentedTokens tokenizeParallel(std::string_view source, size_t threads = 0,
+                                        ErrorMode mode = ErrorMode::Tokens, size_t chunkSize = parallel::minChunkSize) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t chunkCount = std::min(threads, std::max<size_t>(1, source.size() / std::max<size_t>(1, chunkSize)));
+
+    std::vector<parallel::Chunk> chunks;
+    size_t begin = 0;
+    for (size_t i = 1; i <= chunkCount && begin < source.size(); i++) {
+        size_t boundary = i == chunkCount ? source.size() : parallel::findBoundary(source, source.size() / chunkCount * i);
+        if (boundary > begin) {
+            parallel::Chunk chunk;
+            chunk.begin = begin;
+            chunk.boundary = boundary;
+            chunks.push_back(std::move(chunk));
+            begin = boundary;
+        }
+    }
+
+    std::atomic<size_t> next(0);
+    auto work = [&] {
+        Lexer lexer(SourceBuffer::borrow(source));
+        lexer.setErrorMode(mode);
+        for (size_t i = next++; i < chunks.size(); i = next++) {
+            parallel::lexChunk(lexer, chunks[i]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < std::min(threads, chunks.size()); i++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    //chunk 0 starts at the input start and is always right, every later
+    //chunk is only right if its predecessor stopped exactly where it began
+    SegmentedTokens result;
+    Lexer lexer(SourceBuffer::borrow(source));
+    lexer.setErrorMode(mode);
+    size_t resume = 0;
+    for (parallel::Chunk& chunk : chunks) {
+        if (resume >= chunk.boundary) {
+            continue;
+        }
+        if (resume != chunk.begin) {
+            chunk.begin = resume;
+            parallel::lexChunk(lexer, chunk);
+        }
+        if (chunk.error) {
+            std::rethrow_exception(chunk.error);
+        }
+        resume = chunk.end;
+        result.append(std::move(chunk.tokens));
+        result.appendDiagnostics(chunk.problems);
+    }
+    return result;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LEXER_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//read-only source text for a Lexer, either memory mapped from a file or held
+//in an owned heap buffer. The bytes never move once the buffer is created, so
+//views returned by view() stay valid when the SourceBuffer itself is moved.
+class SourceBuffer {
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    std::unique_ptr<char[]> owned;
+    bool mapped = false;
+
+    /// @brief Unmaps or frees the current bytes and leaves the buffer empty.
+    void release() {
+#ifdef LEXER_HAVE_MMAP
+        if (mapped) {
+            munmap(const_cast<char*>(data), length);
+        }
+#endif
+        owned.reset();
+        data = nullptr;
+        length = 0;
+        mapped = false;
+    }
+
+    /// @brief Builds the error thrown when a source file can't be loaded.
+    ///
+    /// @param what The operation that failed.
+    /// @param path The file that was being loaded.
+    ///
+    /// @return A runtime_error naming the file and the system error.
+    static std::runtime_error fileError(const char* what, const std::string& path) {
+        return std::runtime_error(std::string("cannot ") + what + " source file '" + path + "': " + std::strerror(errno));
+    }
+
+    /// @brief Reads a whole file into an owned buffer.
+    ///
+    /// Used where mmap isn't available, or for files mmap refuses such as
+    /// pipes and character devices. Reads straight into the owned buffer,
+    /// which doubles whenever it fills up, so the bytes are never copied
+    /// again once the file has been read.
+    ///
+    /// @param path The file to read.
+    ///
+    /// @return A buffer owning a copy of the file contents.
+    static SourceBuffer readFile(const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            throw fileError("open", path);
+        }
+        SourceBuffer buffer;
+        size_t capacity = 64 * 1024;
+        buffer.owned.reset(new char[capacity]);
+        while (size_t read = std::fread(buffer.owned.get() + buffer.length, 1, capacity - buffer.length, file)) {
+            buffer.length += read;
+            if (buffer.length == capacity) {
+                capacity *= 2;
+                std::unique_ptr<char[]> grown(new char[capacity]);
+                std::memcpy(grown.get(), buffer.owned.get(), buffer.length);
+                buffer.owned = std::move(grown);
+            }
+        }
+        if (std::ferror(file) != 0) {
+            int error = errno;
+            std::fclose(file);
+            errno = error;
+            throw fileError("read", path);
+        }
+        std::fclose(file);
+        buffer.data = buffer.owned.get();
+        return buffer;
+    }
+
+public:
+    SourceBuffer() = default;
+
+    SourceBuffer(SourceBuffer&& other) noexcept
+        : data(other.data), length(other.length), owned(std::move(other.owned)), mapped(other.mapped) {
+        other.data = nullptr;
+        other.length = 0;
+        other.mapped = false;
+    }
+
+    SourceBuffer& operator=(SourceBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            data = other.data;
+            length = other.length;
+            owned = std::move(other.owned);
+            mapped = other.mapped;
+            other.data = nullptr;
+            other.length = 0;
+            other.mapped = false;
+        }
+        return *this;
+    }
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    ~SourceBuffer() {
+        release();
+    }
+
+    /// @brief Creates a buffer holding a copy of the given text.
+    ///
+    /// @param text The source text to copy.
+    ///
+    /// @return A buffer owning its own copy of text.
+    static SourceBuffer fromString(std::string_view text) {
+        SourceBuffer buffer;
+        if (!text.empty()) {
+            buffer.owned.reset(new char[text.size()]);
+            std::memcpy(buffer.owned.get(), text.data(), text.size());
+            buffer.data = buffer.owned.get();
+            buffer.length = text.size();
+        }
+        return buffer;
+    }
+
+    /// @brief Creates a buffer viewing text without copying or owning it.
+    ///
+    /// Lets several lexers share one source, the caller must keep text alive
+    /// for as long as the buffer and every token lexed from it.
+    ///
+    /// @param text The source text to view.
+    ///
+    /// @return A buffer borrowing text.
+    static SourceBuffer borrow(std::string_view text) {
+        SourceBuffer buffer;
+        buffer.data = text.data();
+        buffer.length = text.size();
+        return buffer;
+    }
+
+    /// @brief Loads a source file without copying it into the process.
+    ///
+    /// Regular files are mapped read-only and lexed directly over the page
+    /// cache. Files that can't be mapped, files reporting a size of 0, and
+    /// platforms without mmap fall back to a buffered read.
+    ///
+    /// @param path The file to load.
+    ///
+    /// @return A buffer viewing the file contents.
+    ///
+    /// @throws std::runtime_error If the file can't be opened or read.
+    static SourceBuffer fromFile(const std::string& path) {
+#ifdef LEXER_HAVE_MMAP
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw fileError("open", path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            int error = errno;
+            close(fd);
+            errno = error;
+            throw fileError("stat", path);
+        }
+        //files in /proc and /sys are regular but report a size of 0, reading
+        //finds their contents and still gives nothing for an empty file
+        if (!S_ISREG(info.st_mode) || info.st_size == 0) {
+            close(fd);
+            return readFile(path);
+        }
+
+        size_t size = static_cast<size_t>(info.st_size);
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED) {
+            return readFile(path);
+        }
+#ifdef MADV_SEQUENTIAL
+        madvise(address, size, MADV_SEQUENTIAL);
+#endif
+        SourceBuffer buffer;
+        buffer.data = static_cast<const char*>(address);
+        buffer.length = size;
+        buffer.mapped = true;
+        return buffer;
+#else
+        return readFile(path);
+#endif
+    }
+
+    /// @brief Returns the source text.
+    ///
+    /// @return A view of the bytes, valid for the lifetime of the buffer.
+    std::string_view view() const {
+        return std::string_view(data, length);
+    }
+
+    /// @brief Checks if the bytes are memory mapped rather than copied.
+    ///
+    /// @return True if the buffer maps a file, else false.
+    bool isMapped() const {
+        return mapped;
+    }
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Arena.h"
+#include "Token.h"
+
+//interns identifier names into dense ids, so later stages can compare and
+//hash names as integers. Names are copied into an arena once, the table
+//doesn't depend on the source it was filled from staying alive.
+class SymbolTable {
+private:
+    Arena arena;
+    std::vector<std::string_view> names;
+    std::unordered_map<std::string_view, uint32_t> ids;
+
+public:
+    /// @brief Returns the id of a name, adding it if it's new.
+    ///
+    /// @param name The name to intern.
+    ///
+    /// @return The dense id of name, ids count up from 0 in first-seen order.
+    uint32_t intern(std::string_view name) {
+        auto found = ids.find(name);
+        if (found != ids.end()) {
+            return found->second;
+        }
+        uint32_t id = static_cast<uint32_t>(names.size());
+        std::string_view stored = arena.copy(name);
+        names.push_back(stored);
+        ids.emplace(stored, id);
+        return id;
+    }
+
+    /// @brief Looks up a name without adding it.
+    ///
+    /// @param name The name to look up.
+    ///
+    /// @return The id of name, or Token::noId if it was never interned.
+    uint32_t find(std::string_view name) const {
+        auto found = ids.find(name);
+        return found != ids.end() ? found->second : Token::noId;
+    }
+
+    /// @brief Returns the name behind an id.
+    ///
+    /// @param id An id returned by intern().
+    ///
+    /// @return A view of the interned name, valid for the lifetime of the table.
+    std::string_view name(uint32_t id) const {
+        return names[id];
+    }
+
+    size_t size() const {
+        return names.size();
+    }
+};
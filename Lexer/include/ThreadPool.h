@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//fixed set of worker threads with one task deque each
+//a worker runs its own tasks newest first, which keeps the data it just
+//touched in cache, and when it runs dry it steals the oldest task from
+//another worker. Uneven tasks, like files of very different sizes, then
+//still keep every core busy.
+class ThreadPool {
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex stateLock;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::atomic<size_t> queued{0};
+    size_t unfinished = 0;
+    size_t nextQueue = 0;
+    bool stopping = false;
+
+    static size_t& workerIndex() {
+        thread_local size_t index = SIZE_MAX;
+        return index;
+    }
+
+    /// @brief Takes a task, from the worker's own queue first, else from another's.
+    bool take(size_t self, std::function<void()>& task) {
+        {
+            Queue& own = *queues[self];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); i++) {
+            Queue& victim = *queues[(self + i) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(size_t self) {
+        workerIndex() = self;
+        std::function<void()> task;
+        while (true) {
+            if (take(self, task)) {
+                queued--;
+                task();
+                task = nullptr;
+                std::lock_guard<std::mutex> guard(stateLock);
+                if (--unfinished == 0) {
+                    idle.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(stateLock);
+            wake.wait(guard, [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0) {
+                return;
+            }
+        }
+    }
+
+public:
+    /// @brief Constructor for ThreadPool.
+    ///
+    /// @param threads The number of workers, 0 for one per core.
+    explicit ThreadPool(size_t threads = 0) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (size_t i = 0; i < threads; i++) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (size_t i = 0; i < threads; i++) {
+            workers.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(stateLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /// @brief Queues a task.
+    ///
+    /// Called from a worker the task goes on that worker's own queue, from
+    /// outside the pool tasks are dealt round robin.
+    ///
+    /// @param task The task to run.
+    void submit(std::function<void()> task) {
+        size_t self = workerIndex();
+        {
+            //counted before the push so a thief never sees a task that
+            //isn't accounted for yet, a worker woken early blocks on
+            //stateLock until the push is done
+            std::lock_guard<std::mutex> guard(stateLock);
+            unfinished++;
+            queued++;
+            Queue& queue = *queues[self < queues.size() ? self : nextQueue++ % queues.size()];
+            std::lock_guard<std::mutex> queueGuard(queue.lock);
+            queue.tasks.push_back(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    /// @brief Blocks until every submitted task has finished.
+    void wait() {
+        std::unique_lock<std::mutex> guard(stateLock);
+        idle.wait(guard, [this] { return unfinished == 0; });
+    }
+
+    size_t size() const {
+        return workers.size();
+    }
+
+    /// @brief Returns the index of the calling worker.
+    ///
+    /// @return A value in [0, size()) on a worker thread, SIZE_MAX elsewhere.
+    static size_t currentWorker() {
+        return workerIndex();
+    }
+};
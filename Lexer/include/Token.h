@@ -0,0 +1,256 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+//defines the different types of tokens
+enum class TokenType : uint8_t {
+    Keyword,
+    Identifier,
+    Integer,
+    Float,
+    String,
+    Operator,
+    Delimiter,
+    Unknown
+};
+
+//what a Keyword token is, see keywords::list for spellings
+enum class KeywordKind : uint8_t {
+    None,
+    Int,
+    Float,
+    String,
+    If,
+    Else,
+    While,
+    For,
+    Switch,
+    Case,
+    Default,
+    Break,
+    Continue,
+    Return,
+    Void
+};
+
+//what an Operator or Delimiter token is, see operators::list for spellings
+enum class OperatorKind : uint8_t {
+    None,
+    Plus,
+    Minus,
+    Star,
+    Slash,
+    Percent,
+    Assign,
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    ShiftLeft,
+    ShiftRight,
+    ShiftLeftAssign,
+    ShiftRightAssign,
+    LogicalAnd,
+    LogicalOr,
+    Not,
+    BitAnd,
+    BitOr,
+    BitXor,
+    BitNot,
+    PlusAssign,
+    MinusAssign,
+    StarAssign,
+    SlashAssign,
+    PercentAssign,
+    AndAssign,
+    OrAssign,
+    XorAssign,
+    Increment,
+    Decrement,
+    Arrow,
+    Dot,
+    Scope,
+    Question,
+    //delimiters from here on
+    LeftParen,
+    RightParen,
+    LeftBracket,
+    RightBracket,
+    LeftBrace,
+    RightBrace,
+    Colon,
+    Semicolon,
+    Comma
+};
+
+//represents a token with its type and a view of its lexeme
+//the view points into the SourceBuffer owned by the Lexer that produced it,
+//so a token is only valid while that Lexer is alive
+//identifiers lexed with a SymbolTable attached also carry their interned id,
+//literals lexed with a ConstantPool attached their index into its pool for
+//their type, numeric literals carry their value, keywords, operators and
+//delimiters their kind
+//offset is the byte offset of the lexeme in the source, a LineIndex turns it
+//into a line and column when one is needed
+struct Token {
+    //id of tokens that weren't interned
+    static constexpr uint32_t noId = UINT32_MAX;
+
+    TokenType type;
+    uint32_t id;
+    size_t offset = 0;
+    std::string_view value;
+
+    //parsed value of Integer and Float tokens, converted once while lexing,
+    //and the kind of Keyword, Operator and Delimiter tokens
+    union {
+        int64_t intValue = 0;
+        double floatValue;
+        KeywordKind keywordKind;
+        OperatorKind operatorKind;
+    };
+
+    Token() : type(TokenType::Unknown), id(noId) {
+    };
+
+    Token(TokenType t, std::string_view v, uint32_t id = noId) : type(t), id(id), value(v) {
+    };
+
+    /// @brief Returns the kind of a Keyword, Operator or Delimiter token as a byte.
+    ///
+    /// @return The KeywordKind or OperatorKind, or 0, the None of both, for
+    ///         any other token.
+    uint8_t kindByte() const {
+        switch (type) {
+            case TokenType::Keyword:
+                return static_cast<uint8_t>(keywordKind);
+            case TokenType::Operator:
+            case TokenType::Delimiter:
+                return static_cast<uint8_t>(operatorKind);
+            default:
+                return 0;
+        }
+    }
+
+    /// @brief Copies the lexeme out of the source buffer.
+    ///
+    /// Use this when the token has to outlive the Lexer that produced it.
+    ///
+    /// @return An owning copy of the token's lexeme.
+    std::string str() const {
+        return std::string(value);
+    }
+};
+
+//a token that owns its lexeme, for tokens that have to outlive their Lexer
+//the lexeme is copied once out of the source, or moved in when it already
+//is a string, and only moved from then on
+struct OwnedToken {
+    TokenType type = TokenType::Unknown;
+    uint32_t id = Token::noId;
+    size_t offset = 0;
+    std::string value;
+
+    union {
+        int64_t intValue = 0;
+        double floatValue;
+        KeywordKind keywordKind;
+        OperatorKind operatorKind;
+    };
+
+    OwnedToken() = default;
+
+    /// @brief Constructor for OwnedToken, copying the lexeme of a token.
+    ///
+    /// @param token The token to take the type, position, id and value from.
+    explicit OwnedToken(const Token& token)
+        : type(token.type), id(token.id), offset(token.offset), value(token.value) {
+        copyValue(*this, token);
+    }
+
+    /// @brief Constructor for OwnedToken, taking over an already owned lexeme.
+    ///
+    /// @param type The token type.
+    /// @param value The lexeme, moved from.
+    /// @param id The interned id, if any.
+    OwnedToken(TokenType type, std::string&& value, uint32_t id = Token::noId)
+        : type(type), id(id), value(std::move(value)) {
+    }
+
+    OwnedToken(const OwnedToken&) = default;
+    OwnedToken& operator=(const OwnedToken&) = default;
+    OwnedToken(OwnedToken&&) noexcept = default;
+    OwnedToken& operator=(OwnedToken&&) noexcept = default;
+
+    /// @brief Returns a Token viewing this token's lexeme.
+    ///
+    /// @return The token, valid while this OwnedToken is alive and unchanged.
+    Token view() const {
+        Token token(type, value, id);
+        token.offset = offset;
+        copyValue(token, *this);
+        return token;
+    }
+
+private:
+    /// @brief Copies the union member the type of from makes active.
+    ///
+    /// Reading any other member would be undefined, so to keeps its
+    /// default for token types that carry no value.
+    template <typename To, typename From>
+    static void copyValue(To& to, const From& from) {
+        switch (from.type) {
+            case TokenType::Integer:
+                to.intValue = from.intValue;
+                break;
+            case TokenType::Float:
+                to.floatValue = from.floatValue;
+                break;
+            case TokenType::Keyword:
+                to.keywordKind = from.keywordKind;
+                break;
+            case TokenType::Operator:
+            case TokenType::Delimiter:
+                to.operatorKind = from.operatorKind;
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+/**
+ * @brief Returns a string representing the given TokenType.
+ *
+ * @param type The TokenType to get the string for.
+ *
+ * @return A view of a static name, nothing is allocated.
+ */
+constexpr std::string_view getTokenTypeName(TokenType type) {
+    switch (type) {
+        case TokenType::Keyword:
+            return "keyword";
+        case TokenType::Identifier:
+            return "identifier";
+        case TokenType::Integer:
+            return "integer";
+        case TokenType::Float:
+            return "float";
+        case TokenType::String:
+            return "string";
+        case TokenType::Operator:
+            return "operator";
+        case TokenType::Delimiter:
+            return "delimiter";
+        case TokenType::Unknown:
+            return "unknown";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,397 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#include "CharClass.h"
+#include "Hash.h"
+#include "Lexer.h"
+#include "Operators.h"
+#include "SourceBuffer.h"
+#include "TokenBuffer.h"
+#include "TokenStream.h"
+
+//on-disk cache of token streams keyed by the hash of their source
+//each entry is a fixed header, the diagnostics lexing reported and the tokens
+//in the compact TokenStream encoding, about a third of the size of the
+//TokenBuffer columns.
+//A hit maps the entry and decodes it in one pass, which is much cheaper than
+//lexing. Entries record a fingerprint of the lexer they came from and are
+//ignored once that no longer matches.
+namespace tokencache {
+    //bump whenever the entry layout changes, the token stream has its own version
+    constexpr uint32_t formatVersion = 4;
+
+    //bump whenever lexing rules change in a way the keyword and character
+    //class tables don't capture
+    constexpr uint32_t lexerVersion = 4;
+
+    constexpr char magic[8] = {'L', 'E', 'X', 'T', 'O', 'K', 'C', '\0'};
+    constexpr uint32_t byteOrderMark = 0x01020304;
+
+    /// @brief Fingerprints everything that decides what a token stream looks like.
+    ///
+    /// @return A hash of the keyword list, the operator list, the character
+    ///         class table and lexerVersion.
+    constexpr uint64_t lexerFingerprint() {
+        uint64_t fingerprint = hash::fnv1a("");
+        for (const keywords::Entry& entry : keywords::list) {
+            char kind = static_cast<char>(entry.kind);
+            fingerprint = hash::fnv1a(entry.spelling, fingerprint);
+            fingerprint = hash::fnv1a(std::string_view(&kind, 1), fingerprint);
+        }
+        for (const operators::Entry& entry : operators::list) {
+            char kind = static_cast<char>(entry.kind);
+            fingerprint = hash::fnv1a(entry.spelling, fingerprint);
+            fingerprint = hash::fnv1a(std::string_view(&kind, 1), fingerprint);
+        }
+        for (CharClass charClass : charclass::table) {
+            char byte = static_cast<char>(charClass);
+            fingerprint = hash::fnv1a(std::string_view(&byte, 1), fingerprint);
+        }
+        char version[4] = {static_cast<char>(lexerVersion), static_cast<char>(lexerVersion >> 8),
+                           static_cast<char>(lexerVersion >> 16), static_cast<char>(lexerVersion >> 24)};
+        return hash::fnv1a(std::string_view(version, 4), fingerprint);
+    }
+
+    struct Header {
+        char magic[8];
+        uint32_t formatVersion;
+        uint32_t byteOrder;
+        uint64_t lexerFingerprint;
+        uint64_t sourceHash;
+        uint64_t sourceSize;
+    };
+
+    static_assert(sizeof(Header) == 40, "cache header layout must not depend on the compiler");
+
+    /// @brief Encodes diagnostics as the section following the header.
+    ///
+    /// The section is a varint count and per diagnostic the offset, the
+    /// length and the message, each a varint with the message bytes after it.
+    inline std::string encodeDiagnostics(const std::vector<Diagnostic>& diagnostics) {
+        std::string out;
+        tokenstream::putVarint(out, diagnostics.size());
+        for (const Diagnostic& diagnostic : diagnostics) {
+            size_t length = std::strlen(diagnostic.message);
+            tokenstream::putVarint(out, diagnostic.offset);
+            tokenstream::putVarint(out, diagnostic.length);
+            tokenstream::putVarint(out, length);
+            out.append(diagnostic.message, length);
+        }
+        return out;
+    }
+}
+
+//token stream handed out by a TokenCache, either read from a cache entry or
+//freshly lexed when there was none
+class CachedTokens {
+private:
+    TokenBuffer tokens;
+    std::vector<Diagnostic> problems;
+    //distinct texts the messages of problems point into, moving the vector
+    //keeps them in place
+    std::vector<std::string> messages;
+    bool hit;
+
+    friend class TokenCache;
+
+    CachedTokens(TokenBuffer tokens, bool hit) : tokens(std::move(tokens)), hit(hit) {
+    }
+
+public:
+    CachedTokens(CachedTokens&&) = default;
+    CachedTokens& operator=(CachedTokens&&) = default;
+    CachedTokens(const CachedTokens&) = delete;
+    CachedTokens& operator=(const CachedTokens&) = delete;
+
+    const TokenBuffer& buffer() const {
+        return tokens;
+    }
+
+    /// @brief Returns the diagnostics lexing the source reported.
+    ///
+    /// @return The same list a fresh lex gives, a hit stored it with the
+    ///         tokens. Messages are valid for the lifetime of this object.
+    const std::vector<Diagnostic>& diagnostics() const {
+        return problems;
+    }
+
+    /// @brief Returns the tokens.
+    ///
+    /// @return A view valid for the lifetime of this object.
+    TokenView view() const {
+        return tokens.view();
+    }
+
+    /// @brief Checks if the tokens came from the cache.
+    ///
+    /// @return True for a cache hit, false if the source was lexed.
+    bool fromCache() const {
+        return hit;
+    }
+};
+
+class TokenCache {
+private:
+    std::filesystem::path directory;
+
+    /// @brief Hashes a source, seeded by the error mode so each mode gets its own entry.
+    static uint64_t keyFor(std::string_view source, ErrorMode mode) {
+        return hash::xxh64(source, static_cast<uint64_t>(mode));
+    }
+
+    std::filesystem::path pathFor(uint64_t sourceHash) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.tok", static_cast<unsigned long long>(sourceHash));
+        return directory / name;
+    }
+
+    /// @brief Maps a cache entry and checks it belongs to source and this lexer.
+    std::optional<CachedTokens> load(uint64_t sourceHash, size_t sourceSize) const {
+        std::error_code error;
+        std::filesystem::path path = pathFor(sourceHash);
+        if (!std::filesystem::is_regular_file(path, error)) {
+            return std::nullopt;
+        }
+        SourceBuffer mapping;
+        try {
+            mapping = SourceBuffer::fromFile(path.string());
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+        return decode(mapping.view(), sourceHash, sourceSize);
+    }
+
+    /// @brief Builds the bytes of an entry, header first.
+    static std::string encode(uint64_t sourceHash, size_t sourceSize, const TokenBuffer& tokens,
+                              const std::vector<Diagnostic>& diagnostics) {
+        tokencache::Header header = {};
+        std::memcpy(header.magic, tokencache::magic, sizeof(header.magic));
+        header.formatVersion = tokencache::formatVersion;
+        header.byteOrder = tokencache::byteOrderMark;
+        header.lexerFingerprint = tokencache::lexerFingerprint();
+        header.sourceHash = sourceHash;
+        header.sourceSize = sourceSize;
+        std::string entry(reinterpret_cast<const char*>(&header), sizeof(header));
+        entry += tokencache::encodeDiagnostics(diagnostics);
+        entry += tokenstream::encode(tokens, sourceSize);
+        return entry;
+    }
+
+    /// @brief Decodes the bytes of an entry and checks it belongs to source and this lexer.
+    static std::optional<CachedTokens> decode(std::string_view bytes, uint64_t sourceHash, size_t sourceSize) {
+        if (bytes.size() < sizeof(tokencache::Header)) {
+            return std::nullopt;
+        }
+        tokencache::Header header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.magic, tokencache::magic, sizeof(header.magic)) != 0
+            || header.formatVersion != tokencache::formatVersion
+            || header.byteOrder != tokencache::byteOrderMark
+            || header.lexerFingerprint != tokencache::lexerFingerprint()
+            || header.sourceHash != sourceHash
+            || header.sourceSize != sourceSize) {
+            return std::nullopt;
+        }
+
+        CachedTokens cached(TokenBuffer(), true);
+        const char* cursor = bytes.data() + sizeof(header);
+        const char* end = bytes.data() + bytes.size();
+        if (!readDiagnostics(cursor, end, sourceSize, cached)) {
+            return std::nullopt;
+        }
+        try {
+            TokenStreamReader reader(bytes.substr(cursor - bytes.data()));
+            if (reader.sourceSize() != sourceSize) {
+                return std::nullopt;
+            }
+            reader.readInto(cached.tokens);
+        } catch (const std::runtime_error&) {
+            return std::nullopt;
+        }
+        return cached;
+    }
+
+    /// @brief Decodes the diagnostics section of an entry into cached.
+    ///
+    /// @return False if the section is malformed or a diagnostic lies outside the source.
+    static bool readDiagnostics(const char*& cursor, const char* end, size_t sourceSize, CachedTokens& cached) {
+        uint64_t count;
+        //every diagnostic takes at least 3 bytes
+        if (!tokenstream::getVarint(cursor, end, count) || count > uint64_t(end - cursor) / 3) {
+            return false;
+        }
+        std::vector<size_t> messageOf(count);
+        cached.problems.resize(count);
+        for (uint64_t i = 0; i < count; i++) {
+            uint64_t offset, length, size;
+            if (!tokenstream::getVarint(cursor, end, offset) || !tokenstream::getVarint(cursor, end, length)
+                || !tokenstream::getVarint(cursor, end, size) || size > uint64_t(end - cursor)
+                || offset > sourceSize || length > sourceSize - offset) {
+                return false;
+            }
+            std::string_view message(cursor, size);
+            cursor += size;
+            auto found = std::find(cached.messages.begin(), cached.messages.end(), message);
+            messageOf[i] = found - cached.messages.begin();
+            if (found == cached.messages.end()) {
+                cached.messages.emplace_back(message);
+            }
+            cached.problems[i] = {static_cast<size_t>(offset), static_cast<size_t>(length), nullptr};
+        }
+        //the table is complete, so pointing into it is safe now
+        for (uint64_t i = 0; i < count; i++) {
+            cached.problems[i].message = cached.messages[messageOf[i]].c_str();
+        }
+        return true;
+    }
+
+    /// @brief Returns a suffix for a temporary file that no other writer uses.
+    ///
+    /// The process part mixes a random value drawn once with the pid and the
+    /// start time, so processes sharing a cache directory don't collide even
+    /// with equal pids, e.g. in separate containers. The counter keeps the
+    /// threads of one process apart.
+    static std::string temporarySuffix() {
+        static const uint64_t process = [] {
+            std::random_device random;
+            uint64_t value = uint64_t(random()) << 32 ^ random();
+            value ^= static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#if defined(__unix__) || defined(__APPLE__)
+            value ^= static_cast<uint64_t>(getpid()) << 48;
+#endif
+            return value;
+        }();
+        static std::atomic<uint64_t> counter{0};
+        return ".tmp" + std::to_string(process) + "." + std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    /// @brief Writes an entry next to its final name, then renames it in place.
+    ///
+    /// Readers either see the old entry, the complete new one or nothing.
+    bool write(uint64_t sourceHash, size_t sourceSize, const TokenBuffer& tokens,
+               const std::vector<Diagnostic>& diagnostics) const {
+        std::string entry = encode(sourceHash, sourceSize, tokens, diagnostics);
+        std::filesystem::path path = pathFor(sourceHash);
+        std::filesystem::path temporary = path;
+        temporary += temporarySuffix();
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file) {
+                return false;
+            }
+            file.write(entry.data(), entry.size());
+            if (!file) {
+                std::error_code error;
+                std::filesystem::remove(temporary, error);
+                return false;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        if (error) {
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+        return true;
+    }
+
+public:
+    /// @brief Constructor for TokenCache.
+    ///
+    /// @param directory Where entries are kept, created if missing.
+    ///
+    /// @throws std::filesystem::filesystem_error If the directory can't be created.
+    explicit TokenCache(std::filesystem::path directory) : directory(std::move(directory)) {
+        std::filesystem::create_directories(this->directory);
+    }
+
+    /// @brief Looks up the tokens of a source without lexing it.
+    ///
+    /// @param source The source text.
+    /// @param mode The error mode the tokens were lexed in, streams differ
+    ///        between modes so each has its own entries.
+    ///
+    /// @return The cached tokens, or nothing if there's no valid entry.
+    std::optional<CachedTokens> lookup(std::string_view source, ErrorMode mode = ErrorMode::Tokens) const {
+        return load(keyFor(source, mode), source.size());
+    }
+
+    /// @brief Stores the tokens of a source.
+    ///
+    /// @param source The source text the tokens were lexed from.
+    /// @param tokens The tokens.
+    /// @param diagnostics The diagnostics lexing reported, a hit hands them back.
+    /// @param mode The error mode the tokens were lexed in.
+    ///
+    /// @return True if the entry was written, caching is best effort.
+    bool store(std::string_view source, const TokenBuffer& tokens, const std::vector<Diagnostic>& diagnostics,
+               ErrorMode mode = ErrorMode::Tokens) const {
+        return write(keyFor(source, mode), source.size(), tokens, diagnostics);
+    }
+
+    /// @brief Encodes the entry store() would write, without touching the directory.
+    ///
+    /// @param source The source text the tokens were lexed from.
+    /// @param tokens The tokens.
+    /// @param diagnostics The diagnostics lexing reported.
+    /// @param mode The error mode the tokens were lexed in.
+    ///
+    /// @return The bytes of the entry.
+    static std::string encodeEntry(std::string_view source, const TokenBuffer& tokens,
+                                   const std::vector<Diagnostic>& diagnostics, ErrorMode mode = ErrorMode::Tokens) {
+        return encode(keyFor(source, mode), source.size(), tokens, diagnostics);
+    }
+
+    /// @brief Decodes an entry from memory the way lookup() decodes one from disk.
+    ///
+    /// @param entry The bytes of the entry.
+    /// @param source The source text the entry has to belong to.
+    /// @param mode The error mode the entry has to belong to.
+    ///
+    /// @return The tokens, or nothing if the entry is malformed or for another source.
+    static std::optional<CachedTokens> decodeEntry(std::string_view entry, std::string_view source,
+                                                   ErrorMode mode = ErrorMode::Tokens) {
+        return decode(entry, keyFor(source, mode), source.size());
+    }
+
+    /// @brief Returns the tokens of a source, lexing and caching them on a miss.
+    ///
+    /// @param source The source text.
+    /// @param mode The error mode to lex in.
+    ///
+    /// @return The tokens, offsets are relative to source.
+    ///
+    /// @throws LexError In ErrorMode::FailFast if lexing finds a problem,
+    ///         nothing is cached then.
+    CachedTokens tokenize(std::string_view source, ErrorMode mode = ErrorMode::Tokens) const {
+        uint64_t sourceHash = keyFor(source, mode);
+        if (std::optional<CachedTokens> cached = load(sourceHash, source.size())) {
+            return std::move(*cached);
+        }
+        Lexer lexer(SourceBuffer::borrow(source));
+        lexer.setErrorMode(mode);
+        CachedTokens fresh(TokenBuffer(), false);
+        lexer.tokenize(fresh.tokens);
+        fresh.problems = lexer.diagnostics();
+        write(sourceHash, source.size(), fresh.tokens, fresh.problems);
+        return fresh;
+    }
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "SymbolTable.h"
+#include "Token.h"
+#include "TokenBuffer.h"
+#include "TokenStream.h"
+#include "Utf8.h"
+
+//formats a token dump can be written in
+enum class DumpFormat {
+    Text,
+    JsonLines,
+    Binary
+};
+
+//collects output in a large buffer and hands it to the FILE in big writes
+//instead of flushing per token like endl does
+class OutputBuffer {
+private:
+    std::FILE* file;
+    std::unique_ptr<char[]> buffer;
+    size_t capacity;
+    size_t used = 0;
+
+    /// @brief Hands the collected bytes to the FILE without flushing it.
+    void drain() {
+        size_t count = used;
+        used = 0;
+        if (count != 0 && std::fwrite(buffer.get(), 1, count, file) != count) {
+            throw std::runtime_error("failed to write token dump");
+        }
+    }
+
+public:
+    /// @brief Constructor for OutputBuffer.
+    ///
+    /// @param file Where the output goes.
+    /// @param capacity How much is collected before it's written out.
+    explicit OutputBuffer(std::FILE* file, size_t capacity = 1 << 20)
+        : file(file), buffer(new char[capacity]), capacity(capacity) {
+    }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    ~OutputBuffer() {
+        try {
+            flush();
+        } catch (const std::runtime_error&) {
+        }
+    }
+
+    void append(std::string_view text) {
+        if (text.size() > capacity - used) {
+            drain();
+            if (text.size() > capacity) {
+                if (std::fwrite(text.data(), 1, text.size(), file) != text.size()) {
+                    throw std::runtime_error("failed to write token dump");
+                }
+                return;
+            }
+        }
+        std::memcpy(buffer.get() + used, text.data(), text.size());
+        used += text.size();
+    }
+
+    void append(char c) {
+        if (used == capacity) {
+            drain();
+        }
+        buffer[used++] = c;
+    }
+
+    void append(uint64_t value) {
+        char digits[20];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        append(std::string_view(digits, result.ptr - digits));
+    }
+
+    /// @brief Appends text as the contents of a JSON string, without quotes.
+    ///
+    /// Runs of characters that need no escape are appended in one go. JSON
+    /// has to be valid UTF-8, so every byte that isn't part of a valid
+    /// sequence, such as a stray byte lexed as an Unknown token, becomes
+    /// \ufffd, the replacement character.
+    void appendJsonEscaped(std::string_view text) {
+        static constexpr char hex[] = "0123456789abcdef";
+        size_t run = 0;
+        for (size_t i = 0; i < text.size(); i++) {
+            unsigned char byte = static_cast<unsigned char>(text[i]);
+            if (byte >= 0x80) {
+                uint32_t codePoint;
+                size_t length = utf8::decode(text.data() + i, text.data() + text.size(), codePoint);
+                if (length != 0) {
+                    i += length - 1;
+                    continue;
+                }
+            } else if (byte >= 0x20 && byte != '"' && byte != '\\') {
+                continue;
+            }
+            append(text.substr(run, i - run));
+            if (byte >= 0x80) {
+                append("\\ufffd");
+            } else if (byte >= 0x20) {
+                char escape[2] = {'\\', text[i]};
+                append(std::string_view(escape, sizeof(escape)));
+            } else {
+                char escape[6] = {'\\', 'u', '0', '0', hex[byte >> 4], hex[byte & 15]};
+                append(std::string_view(escape, sizeof(escape)));
+            }
+            run = i + 1;
+        }
+        append(text.substr(run));
+    }
+
+    /// @brief Writes out and flushes everything collected so far.
+    ///
+    /// @throws std::runtime_error If the write fails.
+    void flush() {
+        drain();
+        if (std::fflush(file) != 0) {
+            throw std::runtime_error("failed to write token dump");
+        }
+    }
+};
+
+namespace dump {
+    /// @brief Parses a format name as given on the command line.
+    ///
+    /// @param name One of "text", "json" or "binary".
+    ///
+    /// @return The format, or nothing if name isn't one.
+    inline std::optional<DumpFormat> parseFormat(std::string_view name) {
+        if (name == "text") {
+            return DumpFormat::Text;
+        }
+        if (name == "json") {
+            return DumpFormat::JsonLines;
+        }
+        if (name == "binary") {
+            return DumpFormat::Binary;
+        }
+        return std::nullopt;
+    }
+
+    inline void writeText(OutputBuffer& out, TokenType type, std::string_view value) {
+        out.append("Token: ");
+        out.append(getTokenTypeName(type));
+        out.append(", Value: ");
+        out.append(value);
+        out.append('\n');
+    }
+
+    inline void writeJson(OutputBuffer& out, TokenType type, uint32_t offset, std::string_view value) {
+        out.append("{\"type\":\"");
+        out.append(getTokenTypeName(type));
+        out.append("\",\"offset\":");
+        out.append(uint64_t(offset));
+        out.append(",\"length\":");
+        out.append(uint64_t(value.size()));
+        out.append(",\"value\":\"");
+        out.appendJsonEscaped(value);
+        out.append("\"}\n");
+    }
+}
+
+/**
+ * @brief Writes a token stream in one of the dump formats.
+ *
+ * Text prints one "Token: <type>, Value: <lexeme>" line per token, JSON lines
+ * one object per token with its type, offset, length and lexeme, and binary
+ * the TokenStream encoding.
+ *
+ * @param tokens The tokens to write.
+ * @param source The source text the tokens were lexed from.
+ * @param format The format to write in.
+ * @param file Where to write, flushed once the dump is complete.
+ * @param strings The table the id column refers to, only used by the binary format.
+ *
+ * @throws std::runtime_error If writing fails.
+ */
+inline void dumpTokens(const TokenBuffer& tokens, std::string_view source, DumpFormat format, std::FILE* file,
+                       const SymbolTable* strings = nullptr) {
+    OutputBuffer out(file);
+    switch (format) {
+        case DumpFormat::Text:
+            for (size_t i = 0; i < tokens.size(); i++) {
+                dump::writeText(out, tokens.type(i), tokens.text(i, source));
+            }
+            break;
+        case DumpFormat::JsonLines:
+            for (size_t i = 0; i < tokens.size(); i++) {
+                dump::writeJson(out, tokens.type(i), tokens.offset(i), tokens.text(i, source));
+            }
+            break;
+        case DumpFormat::Binary:
+            out.append(tokenstream::encode(tokens, source.size(), strings));
+            break;
+    }
+    out.flush();
+}
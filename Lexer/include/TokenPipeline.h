@@ -0,0 +1,244 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Lexer.h"
+#include "Token.h"
+
+//bounded single-producer single-consumer ring of token batches
+//a batch changes hands by swapping vectors with a slot, so the consumer's
+//spent batch goes back into the ring and the producer refills its capacity:
+//once every slot has grown to the batch size nothing is allocated. The two
+//indices live on their own cache lines and each side keeps a copy of the
+//other's, so the shared lines are only read when the ring looks full or empty.
+class TokenRing {
+private:
+    static constexpr size_t cacheLine = 64;
+
+    std::vector<std::vector<Token>> slots;
+    size_t mask;
+    //next slot to read, written by the consumer only
+    alignas(cacheLine) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+    //next slot to write, written by the producer only
+    alignas(cacheLine) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+    alignas(cacheLine) std::atomic<bool> closed{false};
+    std::exception_ptr failure;
+
+    static size_t roundUp(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+public:
+    /// @brief Constructor for TokenRing.
+    ///
+    /// @param capacity The number of batches the ring holds, rounded up to a
+    ///        power of two.
+    explicit TokenRing(size_t capacity = 8) : slots(roundUp(capacity)), mask(slots.size() - 1) {
+    }
+
+    TokenRing(const TokenRing&) = delete;
+    TokenRing& operator=(const TokenRing&) = delete;
+
+    size_t capacity() const {
+        return slots.size();
+    }
+
+    /// @brief Hands a batch to the consumer unless the ring is full, producer only.
+    ///
+    /// @param batch The batch to hand over, on success swapped for an
+    ///        emptied batch from an earlier round.
+    ///
+    /// @return False if the ring was full and batch is untouched.
+    bool tryPush(std::vector<Token>& batch) {
+        size_t next = tail.load(std::memory_order_relaxed);
+        if (next - cachedHead == slots.size()) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (next - cachedHead == slots.size()) {
+                return false;
+            }
+        }
+        std::vector<Token>& slot = slots[next & mask];
+        slot.swap(batch);
+        batch.clear();
+        tail.store(next + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Takes the oldest batch unless the ring is empty, consumer only.
+    ///
+    /// @param batch Receives the batch, its previous contents go back into
+    ///        the ring for the producer to reuse.
+    ///
+    /// @return False if there was no batch and batch is untouched.
+    bool tryPop(std::vector<Token>& batch) {
+        size_t next = head.load(std::memory_order_relaxed);
+        if (next == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (next == cachedTail) {
+                return false;
+            }
+        }
+        slots[next & mask].swap(batch);
+        head.store(next + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Marks the end of the stream, producer only.
+    ///
+    /// @param error Why the producer stopped early, rethrown by pop() once
+    ///        the batches before it are taken, or nullptr at the input end.
+    void close(std::exception_ptr error = nullptr) {
+        failure = std::move(error);
+        closed.store(true, std::memory_order_release);
+    }
+
+    /// @brief Takes the next batch, waiting for the producer if needed.
+    ///
+    /// @param batch Receives the batch, see tryPop().
+    ///
+    /// @return False once the ring is closed and drained.
+    ///
+    /// @throws Whatever the producer passed to close().
+    bool pop(std::vector<Token>& batch) {
+        for (unsigned spins = 0;; spins++) {
+            if (tryPop(batch)) {
+                return true;
+            }
+            if (closed.load(std::memory_order_acquire)) {
+                //batches pushed before close() are visible now
+                if (tryPop(batch)) {
+                    return true;
+                }
+                if (failure) {
+                    std::rethrow_exception(failure);
+                }
+                return false;
+            }
+            if (spins >= 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
+
+/**
+ * @brief Lexes on a thread of its own and hands tokens over through a TokenRing.
+ *
+ * Lets a parser consume tokens while the rest of the file is still being
+ * lexed. Memory for tokens is capped at the ring size times the batch size
+ * rather than the whole stream. The lexer belongs to the producer thread
+ * until next() returns false, after which its diagnostics can be read.
+ */
+template <typename Traits = LexerTraits>
+class TokenPipeline {
+private:
+    BasicLexer<Traits>& lexer;
+    TokenRing ring;
+    std::atomic<bool> stopping{false};
+    std::vector<Token> current;
+    size_t index = 0;
+    std::thread producer;
+
+    /// @brief Pushes a batch, waiting while the ring is full.
+    ///
+    /// @return False if the consumer went away first.
+    bool hand(std::vector<Token>& batch) {
+        for (unsigned spins = 0; !ring.tryPush(batch); spins++) {
+            if (stopping.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            if (spins >= 64) {
+                std::this_thread::yield();
+            }
+        }
+        return true;
+    }
+
+    //runs on the producer thread, a lexer exception ends the stream after
+    //the tokens lexed before it, as with a sequential tokenize()
+    void produce(size_t batchSize) {
+        std::vector<Token> batch;
+        std::exception_ptr error;
+        Token token;
+        bool more = true;
+        while (more && !stopping.load(std::memory_order_relaxed)) {
+            try {
+                batch.reserve(batchSize);
+                while (batch.size() < batchSize && (more = lexer.nextToken(token))) {
+                    batch.push_back(token);
+                }
+            } catch (...) {
+                error = std::current_exception();
+                more = false;
+            }
+            if (!batch.empty() && !hand(batch)) {
+                break;
+            }
+        }
+        ring.close(error);
+    }
+
+    void finish() {
+        if (producer.joinable()) {
+            producer.join();
+        }
+    }
+
+public:
+    /// @brief Constructor for TokenPipeline, starts lexing right away.
+    ///
+    /// @param lexer The lexer to drive, not to be touched until next()
+    ///        returns false or the pipeline is destroyed.
+    /// @param batchSize The number of tokens handed over at a time.
+    /// @param ringSize The number of batches that can wait for the consumer.
+    explicit TokenPipeline(BasicLexer<Traits>& lexer, size_t batchSize = 4096, size_t ringSize = 8)
+        : lexer(lexer), ring(ringSize) {
+        producer = std::thread([this, batchSize] { produce(batchSize > 0 ? batchSize : 1); });
+    }
+
+    TokenPipeline(const TokenPipeline&) = delete;
+    TokenPipeline& operator=(const TokenPipeline&) = delete;
+
+    //stops the producer if the consumer gave up early
+    ~TokenPipeline() {
+        stopping.store(true, std::memory_order_relaxed);
+        finish();
+    }
+
+    /// @brief Returns the next token, waiting for the producer if needed.
+    ///
+    /// @param token Receives the token, untouched at the end of input.
+    ///
+    /// @return True if a token was produced, false once the input is exhausted.
+    ///
+    /// @throws LexError In ErrorMode::FailFast, after the tokens before the problem.
+    bool next(Token& token) {
+        if (index == current.size()) {
+            index = 0;
+            try {
+                if (!ring.pop(current)) {
+                    current.clear();
+                    finish();
+                    return false;
+                }
+            } catch (...) {
+                current.clear();
+                finish();
+                throw;
+            }
+        }
+        token = current[index++];
+        return true;
+    }
+};
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SymbolTable.h"
+#include "Token.h"
+#include "TokenBuffer.h"
+
+//compact, versioned binary encoding of a token stream
+//a fixed header is followed by one record per token: a 1-byte type tag, the
+//gap from the end of the previous token as a varint and the length as a
+//varint. Keywords, operators and delimiters follow that with their kind
+//byte, see TokenBuffer. Gaps are mostly whitespace runs and lengths mostly
+//short, so a token usually takes 3 or 4 bytes. If the stream carries a string table every
+//record also ends with a varint id + 1 (0 for none), and the table lists the
+//interned names those ids refer to, so the stream can be read without the
+//source it came from. Only identifiers keep their id, the ids of literals
+//index a ConstantPool the stream doesn't carry.
+namespace tokenstream {
+    constexpr char magic[8] = {'L', 'E', 'X', 'T', 'O', 'K', 'S', '\0'};
+
+    //bump whenever the layout below changes
+    constexpr uint32_t version = 2;
+
+    constexpr uint32_t hasStrings = 1;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t flags;
+        uint64_t tokenCount;
+        uint64_t sourceSize;
+        uint64_t stringCount;
+        uint64_t stringTableOffset;
+    };
+
+    static_assert(sizeof(Header) == 48, "token stream header layout must not depend on the compiler");
+
+    //a decoded token record
+    struct Record {
+        TokenType type = TokenType::Unknown;
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        uint32_t id = Token::noId;
+        uint8_t kind = 0;
+    };
+
+    /// @brief Checks if records of a type carry a kind byte.
+    constexpr bool hasKind(TokenType type) {
+        return type == TokenType::Keyword || type == TokenType::Operator || type == TokenType::Delimiter;
+    }
+
+    /// @brief Appends value as a LEB128 varint, 7 bits per byte, low bits first.
+    inline void putVarint(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    /// @brief Decodes a varint, advancing cursor past it.
+    ///
+    /// @return False if the input ends inside the varint or it overflows 64 bits.
+    inline bool getVarint(const char*& cursor, const char* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+            uint8_t byte = static_cast<uint8_t>(*cursor++);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (byte < 0x80) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Encodes a token stream.
+     *
+     * @param tokens The tokens, offsets relative to their source.
+     * @param sourceSize The byte size of that source.
+     * @param strings The table the id column refers to, or nullptr to leave
+     *        ids and the string table out.
+     *
+     * @return The encoded bytes.
+     */
+    inline std::string encode(const TokenBuffer& tokens, size_t sourceSize, const SymbolTable* strings = nullptr) {
+        bool withStrings = strings && tokens.hasIds();
+        Header header = {};
+        std::memcpy(header.magic, magic, sizeof(header.magic));
+        header.version = version;
+        header.flags = withStrings ? hasStrings : 0;
+        header.tokenCount = tokens.size();
+        header.sourceSize = sourceSize;
+        header.stringCount = withStrings ? strings->size() : 0;
+
+        std::string out(sizeof(header), '\0');
+        out.reserve(sizeof(header) + tokens.size() * (withStrings ? 5 : 4));
+        uint64_t previousEnd = 0;
+        for (size_t i = 0; i < tokens.size(); i++) {
+            out.push_back(static_cast<char>(tokens.type(i)));
+            putVarint(out, tokens.offset(i) - previousEnd);
+            putVarint(out, tokens.length(i));
+            if (hasKind(tokens.type(i))) {
+                out.push_back(static_cast<char>(tokens.kind(i)));
+            }
+            if (withStrings) {
+                uint32_t id = tokens.type(i) == TokenType::Identifier ? tokens.id(i) : Token::noId;
+                putVarint(out, id == Token::noId ? 0 : uint64_t(id) + 1);
+            }
+            previousEnd = uint64_t(tokens.offset(i)) + tokens.length(i);
+        }
+        header.stringTableOffset = out.size();
+        for (size_t i = 0; i < header.stringCount; i++) {
+            std::string_view name = strings->name(static_cast<uint32_t>(i));
+            putVarint(out, name.size());
+            out.append(name);
+        }
+        std::memcpy(&out[0], &header, sizeof(header));
+        return out;
+    }
+}
+
+//reads an encoded token stream in place
+//records are decoded as they're visited and string table entries are views
+//into the encoded bytes, so nothing is copied and the bytes, e.g. a memory
+//mapped file, must outlive the reader.
+class TokenStreamReader {
+private:
+    std::string_view bytes;
+    tokenstream::Header header;
+    const char* cursor = nullptr;
+    const char* recordsEnd = nullptr;
+    uint64_t previousEnd = 0;
+    size_t read = 0;
+    std::vector<std::string_view> strings;
+
+    static std::runtime_error corrupt(const char* what) {
+        return std::runtime_error(std::string("corrupt token stream: ") + what);
+    }
+
+public:
+    /// @brief Constructor for TokenStreamReader.
+    ///
+    /// Checks the header and indexes the string table, records are only
+    /// checked as they are read.
+    ///
+    /// @param bytes The encoded stream.
+    ///
+    /// @throws std::runtime_error If the header or string table is invalid.
+    explicit TokenStreamReader(std::string_view bytes) : bytes(bytes) {
+        if (bytes.size() < sizeof(header)) {
+            throw corrupt("truncated header");
+        }
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.magic, tokenstream::magic, sizeof(header.magic)) != 0) {
+            throw corrupt("bad magic");
+        }
+        if (header.version != tokenstream::version) {
+            throw std::runtime_error("unsupported token stream version " + std::to_string(header.version));
+        }
+        //every record takes at least 3 bytes, which bounds tokenCount before
+        //anything is sized by it
+        if (header.stringTableOffset < sizeof(header) || header.stringTableOffset > bytes.size()
+            || header.tokenCount > (header.stringTableOffset - sizeof(header)) / 3) {
+            throw corrupt("bad string table offset");
+        }
+        cursor = bytes.data() + sizeof(header);
+        recordsEnd = bytes.data() + header.stringTableOffset;
+
+        const char* table = recordsEnd;
+        const char* end = bytes.data() + bytes.size();
+        if (header.stringCount > bytes.size()) {
+            throw corrupt("bad string count");
+        }
+        strings.reserve(header.stringCount);
+        for (uint64_t i = 0; i < header.stringCount; i++) {
+            uint64_t length;
+            if (!tokenstream::getVarint(table, end, length) || length > uint64_t(end - table)) {
+                throw corrupt("truncated string table");
+            }
+            strings.emplace_back(table, length);
+            table += length;
+        }
+    }
+
+    size_t size() const {
+        return header.tokenCount;
+    }
+
+    size_t sourceSize() const {
+        return header.sourceSize;
+    }
+
+    bool hasStrings() const {
+        return header.flags & tokenstream::hasStrings;
+    }
+
+    size_t stringCount() const {
+        return strings.size();
+    }
+
+    /// @brief Returns an entry of the string table.
+    ///
+    /// @param id An id read from a record.
+    ///
+    /// @return A view into the encoded bytes.
+    std::string_view string(uint32_t id) const {
+        return strings[id];
+    }
+
+    /// @brief Decodes the next record.
+    ///
+    /// @param record Receives the token.
+    ///
+    /// @return False once every record has been read.
+    ///
+    /// @throws std::runtime_error If the record is malformed.
+    bool next(tokenstream::Record& record) {
+        if (read == header.tokenCount) {
+            return false;
+        }
+        if (cursor >= recordsEnd) {
+            throw corrupt("truncated records");
+        }
+        uint8_t type = static_cast<uint8_t>(*cursor++);
+        uint64_t gap;
+        uint64_t length;
+        if (type > static_cast<uint8_t>(TokenType::Unknown)
+            || !tokenstream::getVarint(cursor, recordsEnd, gap)
+            || !tokenstream::getVarint(cursor, recordsEnd, length)) {
+            throw corrupt("bad record");
+        }
+        uint64_t offset = previousEnd + gap;
+        if (offset > header.sourceSize || length > header.sourceSize - offset) {
+            throw corrupt("token outside the source");
+        }
+        record.type = static_cast<TokenType>(type);
+        record.offset = static_cast<uint32_t>(offset);
+        record.length = static_cast<uint32_t>(length);
+        record.id = Token::noId;
+        record.kind = 0;
+        if (tokenstream::hasKind(record.type)) {
+            if (cursor >= recordsEnd) {
+                throw corrupt("bad record");
+            }
+            record.kind = static_cast<uint8_t>(*cursor++);
+        }
+        if (hasStrings()) {
+            uint64_t id;
+            if (!tokenstream::getVarint(cursor, recordsEnd, id) || id > strings.size()) {
+                throw corrupt("bad string id");
+            }
+            if (id != 0) {
+                record.id = static_cast<uint32_t>(id - 1);
+            }
+        }
+        previousEnd = offset + length;
+        read++;
+        return true;
+    }
+
+    /// @brief Decodes every remaining record into a buffer.
+    ///
+    /// @param tokens Receives the tokens, ids too if it keeps them.
+    ///
+    /// @throws std::runtime_error If a record is malformed.
+    void readInto(TokenBuffer& tokens) {
+        tokens.reserve(tokens.size() + header.tokenCount - read);
+        tokenstream::Record record;
+        while (next(record)) {
+            tokens.push(record.type, record.offset, record.length, record.id, record.kind);
+        }
+    }
+};
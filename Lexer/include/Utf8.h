@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "UnicodeTables.h"
+
+//for the paths only non-ASCII input takes, keeping them out of the hot loops
+#if defined(__GNUC__)
+#define LEXER_COLD __attribute__((cold, noinline))
+#else
+#define LEXER_COLD
+#endif
+
+//UTF-8 decoding and the identifier properties of non-ASCII code points
+//only reached once a scan stops at a byte of 0x80 or above, so ASCII text
+//never pays for any of it
+namespace utf8 {
+    //longest encoding of a code point
+    constexpr size_t maxLength = 4;
+
+    /// @brief Decodes the code point starting at p.
+    ///
+    /// Rejects overlong encodings, surrogates, code points past 0x10FFFF and
+    /// truncated sequences, so every byte sequence has one reading.
+    ///
+    /// @param p The lead byte.
+    /// @param end The end of the input.
+    /// @param codePoint Receives the code point of a valid sequence.
+    ///
+    /// @return The length of the sequence, 0 if it isn't valid UTF-8.
+    inline size_t decode(const char* p, const char* end, uint32_t& codePoint) {
+        unsigned char lead = static_cast<unsigned char>(*p);
+        size_t length;
+        uint32_t minimum;
+        if (lead < 0x80) {
+            codePoint = lead;
+            return 1;
+        } else if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+            minimum = 0x80;
+            codePoint = lead & 0x1F;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            minimum = 0x800;
+            codePoint = lead & 0x0F;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            minimum = 0x10000;
+            codePoint = lead & 0x07;
+        } else {
+            return 0;
+        }
+        if (static_cast<size_t>(end - p) < length) {
+            return 0;
+        }
+        for (size_t i = 1; i < length; i++) {
+            unsigned char next = static_cast<unsigned char>(p[i]);
+            if ((next & 0xC0) != 0x80) {
+                return 0;
+            }
+            codePoint = codePoint << 6 | (next & 0x3F);
+        }
+        if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+            return 0;
+        }
+        return length;
+    }
+
+    template <size_t N>
+    inline bool inRanges(const unicode::Range (&ranges)[N], uint32_t codePoint) {
+        const unicode::Range* range = std::upper_bound(std::begin(ranges), std::end(ranges), codePoint,
+                                                       [](uint32_t c, const unicode::Range& r) { return c < r.first; });
+        return range != std::begin(ranges) && codePoint <= (range - 1)->last;
+    }
+
+    /// @brief Checks if a non-ASCII code point can start an identifier.
+    inline bool isIdentifierStart(uint32_t codePoint) {
+        return inRanges(unicode::xidStart, codePoint);
+    }
+
+    /// @brief Checks if a non-ASCII code point can continue an identifier.
+    inline bool isIdentifierContinue(uint32_t codePoint) {
+        return inRanges(unicode::xidContinue, codePoint);
+    }
+}
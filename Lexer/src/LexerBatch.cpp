@@ -0,0 +1,117 @@
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../include/BatchLexer.h"
+#include "LexerCli.h"
+
+//the --batch mode of the command line front end
+
+/// @brief Parses a non-negative count given on the command line.
+///
+/// @return The count, or nothing unless text is digits only and fits.
+std::optional<size_t> parseCount(const char* text) {
+    size_t value = 0;
+    const char* end = text + std::strlen(text);
+    auto [last, error] = std::from_chars(text, end, value);
+    if (error != std::errc() || last != end || text == end) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+/**
+ * @brief Lexes a batch of files and prints per-file and total statistics.
+ *
+ * @param argc The argument count from main.
+ * @param argv The arguments from main, starting with --batch.
+ *
+ * @return 0 if every file was lexed, 1 otherwise, also when an argument is
+ *         invalid or the files or the cache directory can't be listed or
+ *         created.
+ */
+int runBatch(int argc, char* argv[]) {
+    size_t threads = 0;
+    std::string cacheDirectory;
+    bool stats = false;
+    ErrorMode mode = ErrorMode::Tokens;
+    std::vector<std::string> paths;
+    for (int i = 2; i < argc; i++) {
+        if ((std::strcmp(argv[i], "--threads") == 0 || std::strcmp(argv[i], "--cache") == 0) && i + 1 == argc) {
+            std::fprintf(stderr, "missing value for %s\n", argv[i]);
+            return 1;
+        }
+        if (std::strcmp(argv[i], "--threads") == 0) {
+            std::optional<size_t> parsed = parseCount(argv[++i]);
+            if (!parsed) {
+                std::fprintf(stderr, "invalid thread count %s, expected a number\n", argv[i]);
+                return 1;
+            }
+            threads = *parsed;
+        } else if (std::strcmp(argv[i], "--recover") == 0) {
+            mode = ErrorMode::Recover;
+        } else if (std::strcmp(argv[i], "--fail-fast") == 0) {
+            mode = ErrorMode::FailFast;
+        } else if (std::strcmp(argv[i], "--cache") == 0) {
+            cacheDirectory = argv[++i];
+        } else if (std::strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        } else if (std::strncmp(argv[i], "--", 2) == 0) {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    std::vector<std::string> files;
+    std::unique_ptr<TokenCache> cache;
+    try {
+        files = batch::collectFiles(paths);
+        if (!cacheDirectory.empty()) {
+            cache = std::make_unique<TokenCache>(cacheDirectory);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    auto begin = std::chrono::steady_clock::now();
+    LexerStats totals;
+    BatchOptions options;
+    options.threads = threads;
+    options.cache = cache.get();
+    options.stats = &totals;
+    options.errorMode = mode;
+    std::vector<FileResult> results = lexFiles(files, options);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    size_t bytes = 0;
+    size_t tokens = 0;
+    size_t failed = 0;
+    size_t cached = 0;
+    for (const FileResult& result : results) {
+        if (!result.error.empty()) {
+            std::fprintf(stderr, "%s\n", result.error.c_str());
+            failed++;
+            continue;
+        }
+        bytes += result.bytes;
+        tokens += result.tokens;
+        cached += result.cached;
+        std::printf("%s: %zu tokens, %zu bytes, %zu diagnostics, %.3f ms%s\n", result.path.c_str(), result.tokens,
+                    result.bytes, result.diagnostics, result.seconds * 1e3, result.cached ? " (cached)" : "");
+    }
+    std::printf("%zu files (%zu cached), %zu tokens, %zu bytes in %.3f ms (%.3f MB/s, %.3f Mtokens/s)\n",
+                results.size() - failed, cached, tokens, bytes, seconds * 1e3, bytes / seconds / 1e6,
+                tokens / seconds / 1e6);
+    if (stats) {
+        printStats(totals);
+    }
+    return failed == 0 ? 0 : 1;
+}
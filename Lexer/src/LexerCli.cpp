@@ -0,0 +1,241 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <optional>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#define LEXER_HAVE_RUSAGE 1
+#endif
+
+#include "../include/Lexer.h"
+#include "../include/TokenDump.h"
+#include "LexerCli.h"
+
+//the command line front end of the lexer library in Lexer.cpp, batch mode
+//lives in LexerBatch.cpp so the thread pool and cache stay out of this file
+//output goes through stdio rather than iostream, which keeps the iostream
+//static initializers out of every short-lived run
+
+/**
+ * @brief Prints the given tokens to the console.
+ *
+ * Iterates over the given vector of tokens and prints each one to the console
+ * with its type and value. Output is buffered and flushed once at the end.
+ *
+ * @param tokens The vector of tokens to be printed.
+ */
+void printTokens(const std::vector<Token>& tokens) {
+    OutputBuffer out(stdout);
+    for (const auto& token : tokens) {
+        dump::writeText(out, token.type, token.value);
+    }
+    out.flush();
+}
+
+/**
+ * @brief Prints lexer counters as JSON to stderr, where they don't mix with a dump.
+ *
+ * @param stats The counters to print.
+ */
+void printStats(const LexerStats& stats) {
+    if (!instrumentation::enabled) {
+        std::fputs("stats unavailable, build with -DLEXER_INSTRUMENTATION=1\n", stderr);
+        return;
+    }
+    std::fprintf(stderr, "%s\n", stats.toJson().c_str());
+}
+
+/// @brief Returns the resident set size of this process in bytes.
+///
+/// @param peak True for the largest it has been so far, else its current size.
+///
+/// @return The size, or 0 where the platform doesn't report it.
+size_t residentBytes(bool peak) {
+#ifdef __linux__
+    if (!peak) {
+        size_t pages = 0;
+        size_t resident = 0;
+        if (std::FILE* file = std::fopen("/proc/self/statm", "r")) {
+            if (std::fscanf(file, "%zu %zu", &pages, &resident) != 2) {
+                resident = 0;
+            }
+            std::fclose(file);
+        }
+        return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+#ifdef LEXER_HAVE_RUSAGE
+    rusage usage;
+    if (peak && getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return static_cast<size_t>(usage.ru_maxrss);
+#else
+        return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+    }
+#endif
+    return 0;
+}
+
+/**
+ * @brief Lexes a file without dumping it and reports what starting up cost.
+ *
+ * Prints one JSON object to stdout: the CPU time spent before main(), on
+ * loading and static initialization, the wall time from entering main() to
+ * the first token and to the last one, the token count and the current and
+ * peak resident set size. Run it as the short-lived processes tooling
+ * starts to track cold-start cost.
+ *
+ * @param path The file to lex, or nullptr for the built-in sample.
+ * @param mode How the lexer handles unexpected characters and problems.
+ * @param started When main() was entered.
+ * @param cpuBeforeMain Processor time used when main() was entered, from std::clock().
+ *
+ * @return 0 on success, 1 if the file can't be read or lexing failed fast.
+ */
+int profileStartup(const char* path, ErrorMode mode, std::chrono::steady_clock::time_point started,
+                   std::clock_t cpuBeforeMain) {
+    using clock = std::chrono::steady_clock;
+    size_t tokens = 0;
+    clock::time_point firstToken;
+    try {
+        Lexer lexer = path ? Lexer::fromFile(path) : Lexer("int main() { return 0; }");
+        lexer.setErrorMode(mode);
+        Token token;
+        bool more = lexer.nextToken(token);
+        firstToken = clock::now();
+        for (; more; more = lexer.nextToken(token)) {
+            tokens++;
+        }
+    } catch (const LexError& e) {
+        std::fprintf(stderr, "%s:%s\n", path ? path : "sample", e.what());
+        return 1;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    clock::time_point finished = clock::now();
+    std::printf("{\"seconds\":{\"beforeMain\":%.6f,\"firstToken\":%.6f,\"allTokens\":%.6f},"
+                "\"tokens\":%zu,\"rssBytes\":%zu,\"peakRssBytes\":%zu}\n",
+                static_cast<double>(cpuBeforeMain) / CLOCKS_PER_SEC,
+                std::chrono::duration<double>(firstToken - started).count(),
+                std::chrono::duration<double>(finished - started).count(), tokens, residentBytes(false),
+                residentBytes(true));
+    return 0;
+}
+
+/**
+ * @brief Tokenizes a file and dumps the tokens.
+ *
+ * Diagnostics go to stderr as path:line:column: message.
+ *
+ * @param path The file to tokenize.
+ * @param format The dump format.
+ * @param mode How the lexer handles unexpected characters and problems.
+ * @param stats True to print the lexer's counters after the dump.
+ *
+ * @return 0 on success, 1 if the file can't be read, the dump can't be
+ *         written or lexing failed fast.
+ */
+int dumpFile(const char* path, DumpFormat format, ErrorMode mode, bool stats) {
+    try {
+        Lexer lexer = Lexer::fromFile(path);
+        lexer.setErrorMode(mode);
+        TokenBuffer tokens;
+        lexer.tokenize(tokens);
+        dumpTokens(tokens, lexer.text(), format, stdout);
+        for (const Diagnostic& problem : lexer.diagnostics()) {
+            SourceLocation where = lexer.locate(problem.offset);
+            std::fprintf(stderr, "%s:%zu:%zu: %s\n", path, where.line, where.column, problem.message);
+        }
+        if (stats) {
+            printStats(lexer.stats());
+        }
+    } catch (const LexError& e) {
+        std::fprintf(stderr, "%s:%s\n", path, e.what());
+        return 1;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Main entry point of the program.
+ *
+ * Without a path, tokenizes a one-line sample program and prints the
+ * resulting tokens. If a file path is given it is memory mapped and
+ * tokenized instead, `--format text|json|binary` picks the dump
+ * format for it, and `--batch [--threads N] [--cache dir] paths...` lexes
+ * every file and directory listed concurrently and reports statistics,
+ * reusing token streams cached in dir for files that haven't changed. With
+ * `--stats` either mode prints the lexer's counters as JSON, in builds with
+ * LEXER_INSTRUMENTATION enabled. `--recover` skips unexpected characters and
+ * reports them instead of emitting Unknown tokens, `--fail-fast` stops at the
+ * first problem, in batch mode skipping the files not started yet.
+ * `--startup` lexes the file, or the sample, without printing tokens and
+ * reports startup time and memory instead, see profileStartup().
+ *
+ * @code
+ * lexer [--format text|json|binary] [--recover|--fail-fast] [--stats] [path]
+ * lexer --startup [--recover|--fail-fast] [path]
+ * lexer --batch [--threads N] [--cache dir] [--recover|--fail-fast] [--stats] paths...
+ * @endcode
+ */
+int main(int argc, char* argv[]) {
+    //taken first, --startup measures from here
+    auto started = std::chrono::steady_clock::now();
+    std::clock_t cpuBeforeMain = std::clock();
+    if (argc > 1 && std::strcmp(argv[1], "--batch") == 0) {
+        return runBatch(argc, argv);
+    }
+    DumpFormat format = DumpFormat::Text;
+    ErrorMode mode = ErrorMode::Tokens;
+    bool stats = false;
+    bool startup = false;
+    int i = 1;
+    for (; i < argc && std::strncmp(argv[i], "--", 2) == 0; i++) {
+        if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            std::optional<DumpFormat> parsed = dump::parseFormat(argv[++i]);
+            if (!parsed) {
+                std::fprintf(stderr, "unknown format %s, expected text, json or binary\n", argv[i]);
+                return 1;
+            }
+            format = *parsed;
+        } else if (std::strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        } else if (std::strcmp(argv[i], "--recover") == 0) {
+            mode = ErrorMode::Recover;
+        } else if (std::strcmp(argv[i], "--fail-fast") == 0) {
+            mode = ErrorMode::FailFast;
+        } else if (std::strcmp(argv[i], "--startup") == 0) {
+            startup = true;
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--format text|json|binary] [--recover|--fail-fast] [--stats] [path]\n"
+                         "       %s --startup [--recover|--fail-fast] [path]\n"
+                         "       %s --batch [--threads N] [--cache dir] [--recover|--fail-fast] [--stats] paths...\n",
+                         argv[0], argv[0], argv[0]);
+            return 1;
+        }
+    }
+    if (startup) {
+        return profileStartup(i < argc ? argv[i] : nullptr, mode, started, cpuBeforeMain);
+    }
+    if (i < argc) {
+        return dumpFile(argv[i], format, mode, stats);
+    }
+
+    std::string input = "int main() { return 0; }";
+    Lexer lexer(input);
+    std::vector<Token> tokens = lexer.tokenize();
+    printTokens(tokens);
+    return 0;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "../include/Instrumentation.h"
+
+//what the translation units of the command line front end share, each
+//function is documented where it is defined
+
+//in LexerCli.cpp
+void printStats(const LexerStats& stats);
+
+//in LexerBatch.cpp, the --batch mode
+int runBatch(int argc, char* argv[]);